@@ -22,17 +22,130 @@
 */
 
 #include "DspChain.h"
-#include "DspContext.h"
+#include "DspDevice.h"
 
 namespace Kiwi
 {
     // ================================================================================ //
-    //                                      DSP CONTEXT                                 //
+    //                                      DSP BRIDGE                                  //
     // ================================================================================ //
     
+    // The bridge reblocks the vectors of the context to the vectors of the chain at the
+    // sample rate of the context, the blocks are then averaged to the sample rate of the
+    // chain and the outputs are interpolated back to the sample rate of the context.
+    class DspChain::Bridge
+    {
+    public:
+        const DspDeviceManager*         device;
+        const ulong                     size;
+        const ulong                     vectorsize;
+        const ulong                     divisor;
+        DspReblocker                    reblocker;
+        vector<sample>                  inputs;
+        vector<sample>                  outputs;
+        vector<sample*>                 input_channels;
+        vector<sample*>                 output_channels;
+        vector<sample>                  mix;
+        vector<sample*>                 mix_channels;
+        vector<sample>                  last;
+        vector<const sample*>           device_inputs;
+        vector<const sample*>           device_input_pointers;
+        vector<sample const* const*>    device_input_bindings;
+        vector<sample*>                 device_output_pointers;
+        vector<sample* const*>          device_output_bindings;
+        vector<ulong>                   written;
+        ulong                           cycle;
+        
+        Bridge(const DspDeviceManager* _device, const ulong _size, const ulong _vectorsize, const ulong _divisor) :
+        device(_device),
+        size(_size),
+        vectorsize(_vectorsize),
+        divisor(_divisor),
+        cycle(0)
+        {
+            const ulong ninputs  = device->getNumberOfInputs();
+            const ulong noutputs = device->getNumberOfOutputs();
+            reblocker.prepare(ninputs, noutputs, vectorsize * divisor, size);
+            
+            // Without division, the nodes use the blocks of the reblocker directly.
+            inputs.assign(divisor > 1 ? ninputs * vectorsize : 0, 0.);
+            outputs.assign(divisor > 1 ? noutputs * vectorsize : 0, 0.);
+            for(ulong i = 0; i < ninputs; i++)
+            {
+                input_channels.push_back(divisor > 1 ? inputs.data() + i * vectorsize : reblocker.getInputs(i));
+                device_input_pointers.push_back(device->getInputsSamples(i));
+            }
+            for(ulong i = 0; i < noutputs; i++)
+            {
+                output_channels.push_back(divisor > 1 ? outputs.data() + i * vectorsize : reblocker.getOutputs(i));
+                device_output_pointers.push_back(device->getOutputsSamples(i));
+            }
+            
+            // If the device doesn't bind its channels, the pointers don't change.
+            for(ulong i = 0; i < ninputs; i++)
+            {
+                sample const* const* binding = device->getInputsBinding(i);
+                device_input_bindings.push_back(binding ? binding : &device_input_pointers[i]);
+            }
+            for(ulong i = 0; i < noutputs; i++)
+            {
+                sample* const* binding = device->getOutputsBinding(i);
+                device_output_bindings.push_back(binding ? binding : &device_output_pointers[i]);
+            }
+            device_inputs.assign(ninputs, nullptr);
+            mix.assign(noutputs * size, 0.);
+            for(ulong i = 0; i < noutputs; i++)
+            {
+                mix_channels.push_back(mix.data() + i * size);
+            }
+            last.assign(noutputs, 0.);
+            written.assign(noutputs, 0);
+        }
+    };
+    
+    // ================================================================================ //
+    //                                      DSP CHAIN                                   //
+    // ================================================================================ //
+    
+    // Mix the bits of a value for the structural hash.
+    static inline ulong mix(ulong x) noexcept
+    {
+        x = (x ^ (x >> 30)) * (ulong)0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * (ulong)0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+    
+    // Check if two lists of linked ports contain the same ports in any order.
+    static bool equals(DspPortList const& a, DspPortList const& b) noexcept
+    {
+        if(a.size() != b.size())
+        {
+            return false;
+        }
+        vector<pair<DspNode*, ulong>> x, y;
+        for(DspPortList::size_type i = 0; i < a.size(); i++)
+        {
+            x.push_back({a[i].node.lock().get(), a[i].index});
+            y.push_back({b[i].node.lock().get(), b[i].index});
+        }
+        sort(x.begin(), x.end());
+        sort(y.begin(), y.end());
+        return x == y;
+    }
+    
     DspChain::DspChain(sDspContext context) noexcept :
     m_context(context),
-    m_running(false)
+    m_running(false),
+    m_asynchronous(false),
+    m_events(4096),
+    m_head(0),
+    m_tail(0),
+    m_time(0),
+    m_samplerate(0),
+    m_vectorsize(0),
+    m_blocksize(0),
+    m_divisor(1),
+    m_stamp(0)
     {
         
     }
@@ -44,8 +157,11 @@ namespace Kiwi
             stop();
         }
         lock_guard<mutex> guard(m_mutex);
+        m_schedule.clear();
         m_nodes.clear();
+        m_nodes_indices.clear();
         m_links.clear();
+        m_links_indices.clear();
     }
     
     sDspDeviceManager DspChain::getDeviceManager() const noexcept
@@ -66,7 +182,7 @@ namespace Kiwi
         sDspContext context = getContext();
         if(context)
         {
-            return context->getSampleRate();
+            return context->getSampleRate() / m_divisor;
         }
         else
         {
@@ -79,7 +195,7 @@ namespace Kiwi
         sDspContext context = getContext();
         if(context)
         {
-            return context->getVectorSize();
+            return m_blocksize ? m_blocksize : context->getVectorSize();
         }
         else
         {
@@ -87,18 +203,29 @@ namespace Kiwi
         }
     }
     
-    void DspChain::add(sDspNode node) throw(DspError&)
+    void DspChain::setVectorSize(const ulong vectorsize) throw(DspError&)
     {
-        if(node)
+        if(vectorsize != m_blocksize)
         {
             const bool state = suspend();
+            m_blocksize = vectorsize;
+            try
             {
-                lock_guard<mutex> guard(m_mutex);
-                if(find(m_nodes.begin(), m_nodes.end(), node) == m_nodes.end())
-                {
-                    m_nodes.push_back(node);
-                }
+                resume(state);
             }
+            catch(DspError& e)
+            {
+                throw e;
+            }
+        }
+    }
+    
+    void DspChain::setRateDivisor(const ulong divisor) throw(DspError&)
+    {
+        if(max(divisor, 1ul) != m_divisor)
+        {
+            const bool state = suspend();
+            m_divisor = max(divisor, 1ul);
             try
             {
                 resume(state);
@@ -110,49 +237,181 @@ namespace Kiwi
         }
     }
     
-    void DspChain::add(sDspLink link)  throw(DspError&)
+    ulong DspChain::getLatency() const noexcept
     {
-        if(link && link->isValid())
+        return m_bridge ? m_bridge->reblocker.getLatency() : 0;
+    }
+    
+    sample const* const* DspChain::getInputsBinding(const ulong channel) const noexcept
+    {
+        if(m_bridge && channel < (ulong)m_bridge->input_channels.size())
         {
-            const bool state = suspend();
+            return &m_bridge->input_channels[channel];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    sample* const* DspChain::getOutputsBinding(const ulong channel) const noexcept
+    {
+        if(m_bridge && channel < (ulong)m_bridge->output_channels.size())
+        {
+            return &m_bridge->output_channels[channel];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    bool DspChain::claimOutput(const ulong channel) const noexcept
+    {
+        if(m_bridge && channel < (ulong)m_bridge->written.size() && m_bridge->written[channel] != m_bridge->cycle)
+        {
+            m_bridge->written[channel] = m_bridge->cycle;
+            return true;
+        }
+        return false;
+    }
+    
+    void DspChain::bridge() const noexcept
+    {
+        Bridge& b = *m_bridge;
+        const ulong ninputs     = (ulong)b.device_inputs.size();
+        const ulong noutputs    = (ulong)b.mix_channels.size();
+        for(ulong i = 0; i < ninputs; i++)
+        {
+            b.device_inputs[i] = *b.device_input_bindings[i];
+        }
+        b.reblocker.process(b.size, ninputs, b.device_inputs.data(), noutputs, b.mix_channels.data(), [this, &b, ninputs, noutputs]()
+        {
+            if(b.divisor > 1)
             {
-                lock_guard<mutex> guard(m_mutex);
-                if(find(m_links.begin(), m_links.end(), link) == m_links.end())
+                for(ulong i = 0; i < ninputs; i++)
                 {
-                    m_links.push_back(link);
+                    Signal::vdecimate(b.vectorsize, b.divisor, b.reblocker.getInputs(i), b.input_channels[i]);
                 }
             }
-            try
+            b.cycle++;
+            perform();
+            for(ulong i = 0; i < noutputs; i++)
             {
-                resume(state);
+                if(b.written[i] != b.cycle)
+                {
+                    Signal::vclear(b.vectorsize, b.output_channels[i]);
+                }
+                if(b.divisor > 1)
+                {
+                    b.last[i] = Signal::vinterpolate(b.vectorsize, b.divisor, b.last[i], b.output_channels[i], b.reblocker.getOutputs(i));
+                }
             }
-            catch(DspError& e)
+        });
+        
+        // The channels that the chain has written once are added to the outputs of the
+        // device because the bridge delays them.
+        for(ulong i = 0; i < noutputs; i++)
+        {
+            sample* out = *b.device_output_bindings[i];
+            if(b.written[i] && out)
             {
-                throw e;
+                if(b.device->claimOutput(i))
+                {
+                    Signal::vcopy(b.size, b.mix_channels[i], out);
+                }
+                else
+                {
+                    Signal::vadd(b.size, b.mix_channels[i], out);
+                }
             }
         }
     }
     
-    void DspChain::remove(sDspNode node) throw(DspError&)
+    void DspChain::add(sDspNode node) throw(DspError&)
     {
         if(node)
         {
-            const bool state = suspend();
+            // Once the chain is compiled asynchronously, the edits don't stop it anymore,
+            // they're applied by the next compilation.
+            const bool asynchronous = m_asynchronous;
+            const bool state = asynchronous ? false : suspend();
+            {
+                lock_guard<mutex> compiling(m_compile);
+                lock_guard<mutex> guard(m_mutex);
+                insertIndexed(m_nodes, m_nodes_indices, node);
+            }
+            if(!asynchronous)
             {
+                try
+                {
+                    resume(state);
+                }
+                catch(DspError& e)
+                {
+                    throw e;
+                }
+            }
+        }
+    }
+    
+    void DspChain::add(sDspLink link)  throw(DspError&)
+    {
+        if(link && link->isValid())
+        {
+            const bool asynchronous = m_asynchronous;
+            const bool state = asynchronous ? false : suspend();
+            {
+                lock_guard<mutex> compiling(m_compile);
                 lock_guard<mutex> guard(m_mutex);
-                auto it = find(m_nodes.begin(), m_nodes.end(), node);
-                if(it != m_nodes.end())
+                insertIndexed(m_links, m_links_indices, link);
+            }
+            if(!asynchronous)
+            {
+                try
+                {
+                    resume(state);
+                }
+                catch(DspError& e)
                 {
-                    m_nodes.erase(it);
+                    throw e;
                 }
             }
-            try
+        }
+    }
+    
+    void DspChain::remove(sDspNode node) throw(DspError&)
+    {
+        if(node)
+        {
+            const bool asynchronous = m_asynchronous;
+            const bool state = asynchronous ? false : suspend();
             {
-                resume(state);
+                lock_guard<mutex> compiling(m_compile);
+                lock_guard<mutex> guard(m_mutex);
+                eraseIndexed(m_nodes, m_nodes_indices, node);
+                
+                // The pending changes of the node are ignored because it can be deleted.
+                const ulong tail = m_tail.load(memory_order_acquire);
+                for(ulong i = m_head.load(memory_order_relaxed); i != tail; i++)
+                {
+                    Event& event = m_events[i & (m_events.size() - 1)];
+                    if(event.node == node.get())
+                    {
+                        event.parameter = nullptr;
+                    }
+                }
             }
-            catch(DspError& e)
+            if(!asynchronous)
             {
-                throw e;
+                try
+                {
+                    resume(state);
+                }
+                catch(DspError& e)
+                {
+                    throw e;
+                }
             }
         }
     }
@@ -161,53 +420,371 @@ namespace Kiwi
     {
         if(link)
         {
-            const bool state = suspend();
+            const bool asynchronous = m_asynchronous;
+            const bool state = asynchronous ? false : suspend();
             {
+                lock_guard<mutex> compiling(m_compile);
                 lock_guard<mutex> guard(m_mutex);
-                auto it = find(m_links.begin(), m_links.end(), link);
-                if(it != m_links.end())
+                eraseIndexed(m_links, m_links_indices, link);
+            }
+            if(!asynchronous)
+            {
+                try
+                {
+                    resume(state);
+                }
+                catch(DspError& e)
                 {
-                    m_links.erase(it);
+                    throw e;
                 }
             }
-            try
+        }
+    }
+    
+    void DspChain::post(DspNode* node, DspParameter* parameter, const sample value, const ulong time) noexcept
+    {
+        const ulong tail = m_tail.load(memory_order_relaxed);
+        if(tail - m_head.load(memory_order_acquire) >= (ulong)m_events.size())
+        {
+            // The audio thread can't dispatch while the mutex is owned,
+            // so the pending changes are applied here without their times.
+            lock_guard<mutex> guard(m_mutex);
+            const ulong last = m_tail.load(memory_order_acquire);
+            ulong head = m_head.load(memory_order_relaxed);
+            while(head != last)
             {
-                resume(state);
+                Event const& event = m_events[head & (m_events.size() - 1)];
+                if(event.parameter)
+                {
+                    event.parameter->setValue(event.value);
+                }
+                head++;
             }
-            catch(DspError& e)
+            m_head.store(head, memory_order_release);
+        }
+        m_events[tail & (m_events.size() - 1)] = {node, parameter, value, time};
+        m_tail.store(tail + 1, memory_order_release);
+    }
+    
+    void DspChain::sortNodes(Graph const& graph, vector<ulong>& order, vector<vector<ulong>>& loops) noexcept
+    {
+        const ulong size = (ulong)graph.first.size() - 1;
+        vector<ulong> numbers(size, 0);
+        vector<ulong> lows(size, 0);
+        vector<char>  stacked(size, 0);
+        vector<ulong> components;
+        vector<pair<ulong, ulong>> calls;
+        components.reserve(size);
+        calls.reserve(size);
+        order.reserve(size);
+        ulong number = 0;
+        
+        // The calls of the depth-first search are stacked with the next edge to
+        // visit, a node is sorted when all the nodes it depends on are sorted.
+        for(ulong root = 0; root < size; root++)
+        {
+            if(!numbers[root])
             {
-                throw e;
+                numbers[root] = lows[root] = ++number;
+                stacked[root] = 1;
+                components.push_back(root);
+                calls.push_back(make_pair(root, graph.first[root]));
+                while(!calls.empty())
+                {
+                    const ulong node = calls.back().first;
+                    if(calls.back().second < graph.first[node + 1])
+                    {
+                        const ulong next = graph.edges[calls.back().second++];
+                        if(!numbers[next])
+                        {
+                            numbers[next] = lows[next] = ++number;
+                            stacked[next] = 1;
+                            components.push_back(next);
+                            calls.push_back(make_pair(next, graph.first[next]));
+                        }
+                        else if(stacked[next])
+                        {
+                            lows[node] = min(lows[node], numbers[next]);
+                        }
+                    }
+                    else
+                    {
+                        calls.pop_back();
+                        if(!calls.empty())
+                        {
+                            lows[calls.back().first] = min(lows[calls.back().first], lows[node]);
+                        }
+                        if(lows[node] == numbers[node])
+                        {
+                            vector<ulong>::iterator it = components.end();
+                            while(*(--it) != node)
+                            {
+                                ;
+                            }
+                            const bool loop = components.end() - it > 1;
+                            for(vector<ulong>::iterator jt = it; jt != components.end(); ++jt)
+                            {
+                                stacked[*jt] = 0;
+                            }
+                            if(loop)
+                            {
+                                loops.push_back(vector<ulong>(it, components.end()));
+                            }
+                            else
+                            {
+                                order.push_back(node);
+                            }
+                            components.erase(it, components.end());
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    bool DspChain::isDependent(Graph const& graph, vector<ulong> const& positions, vector<ulong>& marks, const ulong mark, const ulong node, const ulong other) noexcept
+    {
+        // The nodes placed before the other node can't depend on it.
+        vector<ulong> nodes(1, node);
+        marks[node] = mark;
+        while(!nodes.empty())
+        {
+            const ulong current = nodes.back();
+            nodes.pop_back();
+            for(ulong i = graph.first[current]; i < graph.first[current + 1]; i++)
+            {
+                const ulong next = graph.edges[i];
+                if(next == other)
+                {
+                    return true;
+                }
+                else if(marks[next] != mark && positions[next] > positions[other])
+                {
+                    marks[next] = mark;
+                    nodes.push_back(next);
+                }
             }
         }
+        return false;
     }
     
-    void DspChain::sortNodes(set<sDspNode>& nodes, ulong& index, sDspNode node) throw(DspError&)
+    ulong DspChain::getHash() const noexcept
     {
-        if(!node->index)
+        // The nodes and the links are summed so their order doesn't matter.
+        ulong hash = mix((ulong)m_nodes.size());
+        for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
+        {
+            hash += mix((ulong)m_nodes[i].get());
+        }
+        for(vector<sDspLink>::size_type i = 0; i < m_links.size(); i++)
         {
-            nodes.insert(node);
-            for(vector<sDspNode>::size_type i = 0; i < node->getNumberOfInputs(); i++)
+            const ulong from = mix((ulong)m_links[i]->getOutpuNode().get() ^ mix(m_links[i]->getOutputIndex()));
+            const ulong to   = mix((ulong)m_links[i]->getInputNode().get() ^ mix(m_links[i]->getInputIndex()));
+            hash += mix(from ^ mix(to));
+        }
+        return hash;
+    }
+    
+    void DspChain::order() throw(DspError&)
+    {
+        const ulong hash = getHash();
+        for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
+        {
+            m_nodes[i]->index = 0;
+        }
+        
+        // The order of a known schedule is checked against the links in case of a
+        // collision of the hashes.
+        for(vector<Schedule>::size_type i = 0; i < m_schedules.size(); i++)
+        {
+            if(m_schedules[i].hash == hash && m_schedules[i].nodes.size() == m_nodes.size())
             {
-                DspNodeSet& link = node->m_inputs[i]->m_links;
-                for(auto it = link.begin(); it != link.end(); ++it)
+                bool valid = true;
+                for(vector<wDspNode>::size_type j = 0; j < m_schedules[i].nodes.size() && valid; j++)
                 {
-                    sDspNode input = (*it).lock();
-                    if(input && !input->index)
+                    sDspNode node = m_schedules[i].nodes[j].lock();
+                    valid = node && !node->index;
+                    if(valid)
                     {
-                        if(nodes.find(input) != nodes.end())
+                        node->index = j + 1;
+                    }
+                }
+                for(vector<sDspNode>::size_type j = 0; j < m_nodes.size() && valid; j++)
+                {
+                    valid = m_nodes[j]->index != 0;
+                }
+                for(vector<sDspLink>::size_type j = 0; j < m_links.size() && valid; j++)
+                {
+                    sDspNode from = m_links[j]->getOutpuNode();
+                    sDspNode to   = m_links[j]->getInputNode();
+                    valid = !from || !to || from == to || from->index < to->index;
+                }
+                if(valid)
+                {
+                    m_schedules[i].stamp = ++m_stamp;
+                    return;
+                }
+                for(vector<sDspNode>::size_type j = 0; j < m_nodes.size(); j++)
+                {
+                    m_nodes[j]->index = 0;
+                }
+                m_schedules.erase(m_schedules.begin() + (long)i);
+                break;
+            }
+        }
+        
+        // The nodes are identified by their positions in the chain during the sort,
+        // the links to nodes that aren't in the chain are ignored.
+        const ulong size = (ulong)m_nodes.size();
+        for(ulong i = 0; i < size; i++)
+        {
+            m_nodes[i]->index = i + 1;
+        }
+        Graph links, predecessors;
+        links.first.reserve(size + 1);
+        links.edges.reserve(m_links.size());
+        predecessors.first.reserve(size + 1);
+        vector<sDspNode> temp;
+        for(ulong i = 0; i < size; i++)
+        {
+            links.first.push_back((ulong)links.edges.size());
+            for(ulong j = 0; j < m_nodes[i]->getNumberOfInputs(); j++)
+            {
+                DspPortList const& ports = m_nodes[i]->m_inputs[j].m_links;
+                for(DspPortList::size_type k = 0; k < ports.size(); k++)
+                {
+                    sDspNode input = ports[k].node.lock();
+                    if(input && input->index && input->index <= size && m_nodes[input->index - 1] == input)
+                    {
+                        links.edges.push_back(input->index - 1);
+                    }
+                }
+            }
+            predecessors.first.push_back((ulong)predecessors.edges.size());
+            temp.clear();
+            m_nodes[i]->getPredecessors(temp);
+            for(vector<sDspNode>::size_type j = 0; j < temp.size(); j++)
+            {
+                sDspNode predecessor = temp[j];
+                if(predecessor && predecessor != m_nodes[i] && predecessor->index && predecessor->index <= size && m_nodes[predecessor->index - 1] == predecessor)
+                {
+                    predecessors.edges.push_back(predecessor->index - 1);
+                }
+            }
+        }
+        links.first.push_back((ulong)links.edges.size());
+        predecessors.first.push_back((ulong)predecessors.edges.size());
+        
+        vector<ulong> order;
+        vector<vector<ulong>> loops;
+        sortNodes(links, order, loops);
+        if(!loops.empty())
+        {
+            vector<vector<wDspNode>> nodes(loops.size());
+            for(vector<vector<ulong>>::size_type i = 0; i < loops.size(); i++)
+            {
+                for(vector<ulong>::size_type j = 0; j < loops[i].size(); j++)
+                {
+                    nodes[i].push_back(m_nodes[loops[i][j]]);
+                }
+            }
+            throw DspError(nodes);
+        }
+        
+        // The predecessors that aren't linked are sorted before the nodes only if
+        // they don't depend on them, otherwise they break the loop. When several
+        // predecessors close a loop together, the last one of the loop is ignored.
+        if(!predecessors.edges.empty())
+        {
+            vector<ulong> positions(size), marks(size, 0), components(size, 0);
+            vector<char>  accepted(predecessors.edges.size(), 0);
+            for(ulong i = 0; i < size; i++)
+            {
+                positions[order[i]] = i;
+            }
+            ulong mark = 0;
+            for(ulong i = 0; i < size; i++)
+            {
+                for(ulong j = predecessors.first[i]; j < predecessors.first[i + 1]; j++)
+                {
+                    const ulong predecessor = predecessors.edges[j];
+                    accepted[j] = positions[predecessor] < positions[i] || !isDependent(links, positions, marks, ++mark, predecessor, i);
+                }
+            }
+            while(true)
+            {
+                Graph graph;
+                graph.first.reserve(size + 1);
+                graph.edges.reserve(links.edges.size() + predecessors.edges.size());
+                for(ulong i = 0; i < size; i++)
+                {
+                    graph.first.push_back((ulong)graph.edges.size());
+                    graph.edges.insert(graph.edges.end(), links.edges.begin() + (long)links.first[i], links.edges.begin() + (long)links.first[i + 1]);
+                    for(ulong j = predecessors.first[i]; j < predecessors.first[i + 1]; j++)
+                    {
+                        if(accepted[j])
                         {
-                            throw DspError(input, DspError::Loop);
+                            graph.edges.push_back(predecessors.edges[j]);
                         }
-                        else
+                    }
+                }
+                graph.first.push_back((ulong)graph.edges.size());
+                
+                order.clear();
+                loops.clear();
+                sortNodes(graph, order, loops);
+                if(loops.empty())
+                {
+                    break;
+                }
+                for(vector<vector<ulong>>::size_type i = 0; i < loops.size(); i++)
+                {
+                    for(vector<ulong>::size_type j = 0; j < loops[i].size(); j++)
+                    {
+                        components[loops[i][j]] = i + 1;
+                    }
+                    ulong last = 0;
+                    for(vector<ulong>::size_type j = 0; j < loops[i].size(); j++)
+                    {
+                        const ulong node = loops[i][j];
+                        for(ulong k = predecessors.first[node]; k < predecessors.first[node + 1]; k++)
                         {
-                            sortNodes(nodes, index, input);
+                            if(accepted[k] && components[predecessors.edges[k]] == i + 1)
+                            {
+                                last = max(last, k + 1);
+                            }
                         }
                     }
+                    if(last)
+                    {
+                        accepted[last - 1] = 0;
+                    }
+                    for(vector<ulong>::size_type j = 0; j < loops[i].size(); j++)
+                    {
+                        components[loops[i][j]] = 0;
+                    }
                 }
             }
-            
-            nodes.erase(node);
-            node->index = index++;
+        }
+        
+        vector<sDspNode> nodes(size);
+        for(ulong i = 0; i < size; i++)
+        {
+            nodes[i] = m_nodes[order[i]];
+            nodes[i]->index = i + 1;
+        }
+        Schedule schedule = {hash, ++m_stamp, vector<wDspNode>(nodes.begin(), nodes.end())};
+        if(m_schedules.size() >= c_schedules)
+        {
+            auto last = min_element(m_schedules.begin(), m_schedules.end(), [](Schedule const& a, Schedule const& b)
+            {
+                return a.stamp < b.stamp;
+            });
+            *last = schedule;
+        }
+        else
+        {
+            m_schedules.push_back(schedule);
         }
     }
     
@@ -218,57 +795,361 @@ namespace Kiwi
             stop();
         }
         
+        lock_guard<mutex> compiling(m_compile);
+        m_asynchronous = false;
+        try
+        {
+            build();
+        }
+        catch(DspError& e)
+        {
+            throw e;
+        }
+    }
+    
+    future<void> DspChain::compile()
+    {
+        // The chain is kept alive by the task until the new schedule is published.
+        m_asynchronous = true;
+        sDspChain chain = shared_from_this();
+        return async(launch::async, [chain]()
+        {
+            lock_guard<mutex> compiling(chain->m_compile);
+            if(chain->m_running)
+            {
+                chain->update();
+            }
+            else
+            {
+                chain->build();
+            }
+        });
+    }
+    
+    void DspChain::build() throw(DspError&)
+    {
         lock_guard<mutex> guard(m_mutex);
+        m_samplerate = getSampleRate();
+        m_vectorsize = getVectorSize();
+        prepareBridge();
         
         for(vector<sDspLink>::size_type i = 0; i < m_links.size(); i++)
         {
             m_links[i]->start();
         }
+        try
+        {
+            order();
+        }
+        catch(DspError& e)
+        {
+            throw e;
+        }
+        sort(m_nodes.begin(), m_nodes.end(), [](sDspNode const& a, sDspNode const& b)
+        {
+            return a->index < b->index;
+        });
         for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
         {
-            m_nodes[i]->index = 0;
+            m_nodes_indices[m_nodes[i].get()] = (ulong)i;
         }
+        m_schedule = m_nodes;
         
-        ulong index = 1;
-        set<sDspNode> temp;
         for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
         {
             try
             {
-                sortNodes(temp, index, m_nodes[i]);
+                m_nodes[i]->start();
             }
             catch(DspError& e)
             {
                 throw e;
             }
         }
-        temp.clear();
+        connect();
         
+        m_running = true;
+    }
+    
+    void DspChain::update() throw(DspError&)
+    {
+        // The edits can't change the nodes and the links while the compile mutex is owned
+        // and the audio thread only reads the vectors of the schedule, so the links and
+        // the order are computed without the mutex of the chain.
+        struct State
+        {
+            ulong               index;
+            vector<DspPortList> inputs;
+            vector<DspPortList> outputs;
+        };
+        const ulong size = (ulong)m_nodes.size();
+        vector<State> states(size);
+        for(ulong i = 0; i < size; i++)
+        {
+            DspNode* node = m_nodes[i].get();
+            states[i].index = node->index;
+            for(ulong j = 0; j < node->getNumberOfInputs(); j++)
+            {
+                states[i].inputs.push_back(node->m_inputs[j].m_links);
+                node->m_inputs[j].m_links.clear();
+            }
+            for(ulong j = 0; j < node->getNumberOfOutputs(); j++)
+            {
+                states[i].outputs.push_back(node->m_outputs[j].m_links);
+                node->m_outputs[j].m_links.clear();
+            }
+        }
+        for(vector<sDspLink>::size_type i = 0; i < m_links.size(); i++)
+        {
+            m_links[i]->start();
+        }
+        
+        try
+        {
+            order();
+        }
+        catch(DspError& e)
+        {
+            // The links of the schedule are restored so it can be resized.
+            for(ulong i = 0; i < size; i++)
+            {
+                DspNode* node = m_nodes[i].get();
+                node->index = states[i].index;
+                for(ulong j = 0; j < node->getNumberOfInputs(); j++)
+                {
+                    node->m_inputs[j].m_links = states[i].inputs[j];
+                }
+                for(ulong j = 0; j < node->getNumberOfOutputs(); j++)
+                {
+                    node->m_outputs[j].m_links = states[i].outputs[j];
+                }
+            }
+            throw e;
+        }
+        
+        // The new nodes and the nodes whose links changed are prepared again. A node that
+        // shares the state of its predecessors is prepared again if one of them is or if
+        // their order changed, until no other node changes.
+        unordered_set<const DspNode*> scheduled;
+        for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
+        {
+            scheduled.insert(m_schedule[i].get());
+        }
+        vector<bool> changed(size, false);
+        vector<vector<ulong>> predecessors(size);
+        for(ulong i = 0; i < size; i++)
+        {
+            DspNode* node = m_nodes[i].get();
+            if(scheduled.find(node) == scheduled.end())
+            {
+                changed[i] = true;
+            }
+            else
+            {
+                for(ulong j = 0; j < node->getNumberOfInputs() && !changed[i]; j++)
+                {
+                    changed[i] = !equals(states[i].inputs[j], node->m_inputs[j].m_links);
+                }
+                for(ulong j = 0; j < node->getNumberOfOutputs() && !changed[i]; j++)
+                {
+                    changed[i] = !equals(states[i].outputs[j], node->m_outputs[j].m_links);
+                }
+            }
+            vector<sDspNode> nodes;
+            node->getPredecessors(nodes);
+            for(vector<sDspNode>::size_type j = 0; j < nodes.size(); j++)
+            {
+                auto it = m_nodes_indices.find(nodes[j].get());
+                if(it != m_nodes_indices.end() && it->second != i)
+                {
+                    predecessors[i].push_back(it->second);
+                }
+            }
+        }
+        for(bool propagate = true; propagate;)
+        {
+            propagate = false;
+            for(ulong i = 0; i < size; i++)
+            {
+                for(vector<ulong>::size_type j = 0; j < predecessors[i].size() && !changed[i]; j++)
+                {
+                    const ulong other = predecessors[i][j];
+                    const bool before = states[other].index < states[i].index;
+                    changed[i] = changed[other] || before != (m_nodes[other]->index < m_nodes[i]->index);
+                    propagate  = propagate || changed[i];
+                }
+            }
+        }
+        
+        // The changed nodes are removed from the schedule so the audio thread doesn't
+        // perform them while they're prepared without the mutex, their signals are still
+        // read by the other nodes until the new schedule is published.
+        vector<sDspNode> schedule;
+        for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
+        {
+            auto it = m_nodes_indices.find(m_schedule[i].get());
+            if(it == m_nodes_indices.end() || !changed[it->second])
+            {
+                schedule.push_back(m_schedule[i]);
+            }
+        }
+        {
+            lock_guard<mutex> guard(m_mutex);
+            m_schedule.swap(schedule);
+        }
+        for(ulong i = 0; i < size; i++)
+        {
+            DspNode* node = m_nodes[i].get();
+            if(changed[i])
+            {
+                if(scheduled.find(node) != scheduled.end())
+                {
+                    node->m_running = false;
+                    node->release();
+                }
+                node->setup();
+            }
+        }
+        
+        // The flags are stored in the order of the nodes so they follow the sort.
+        vector<bool> allocations(size, false);
+        for(ulong i = 0; i < size; i++)
+        {
+            allocations[m_nodes[i]->index - 1] = changed[i];
+        }
+        
+        lock_guard<mutex> guard(m_mutex);
+        for(vector<sDspNode>::size_type i = 0; i < schedule.size(); i++)
+        {
+            if(m_nodes_indices.find(schedule[i].get()) == m_nodes_indices.end())
+            {
+                schedule[i]->stop();
+            }
+        }
+        sort(m_nodes.begin(), m_nodes.end(), [](sDspNode const& a, sDspNode const& b)
+        {
+            return a->index < b->index;
+        });
         for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
+        {
+            m_nodes_indices[m_nodes[i].get()] = (ulong)i;
+        }
+        m_schedule = m_nodes;
+        for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
         {
             try
             {
-                m_nodes[i]->start();
+                if(allocations[i])
+                {
+                    m_schedule[i]->allocate();
+                }
             }
             catch(DspError& e)
             {
+                // The schedule can't be restored anymore so the chain is stopped.
+                m_running = false;
+                for(vector<sDspNode>::size_type j = 0; j < m_schedule.size(); j++)
+                {
+                    m_schedule[j]->stop();
+                }
                 throw e;
             }
         }
+        connect();
+    }
+    
+    void DspChain::resize() throw(DspError&)
+    {
+        lock_guard<mutex> compiling(m_compile);
+        if(m_running)
+        {
+            lock_guard<mutex> guard(m_mutex);
+            sDspContext context = getContext();
+            const ulong size        = context ? context->getVectorSize() : 0;
+            const ulong samplerate  = getSampleRate();
+            const ulong vectorsize  = getVectorSize();
+            const bool  bridged     = vectorsize != size || m_divisor > 1;
+            if(samplerate == m_samplerate && vectorsize == m_vectorsize && bridged == bool(m_bridge) && (!m_bridge || m_bridge->size == size))
+            {
+                return;
+            }
+            
+            // The nodes keep their order and their links, only their signals are allocated
+            // again and they're resized.
+            m_samplerate = samplerate;
+            m_vectorsize = vectorsize;
+            prepareBridge();
+            for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
+            {
+                try
+                {
+                    m_schedule[i]->restart();
+                }
+                catch(DspError& e)
+                {
+                    throw e;
+                }
+            }
+            connect();
+        }
+    }
+    
+    void DspChain::prepareBridge()
+    {
+        // The bridge is prepared before the nodes so they can use its channels.
+        m_bridge.reset();
+        sDspContext context = getContext();
+        sDspDeviceManager device = getDeviceManager();
+        if(context && device && m_vectorsize && (m_vectorsize != context->getVectorSize() || m_divisor > 1))
+        {
+            m_bridge = unique_ptr<Bridge>(new Bridge(device.get(), context->getVectorSize(), m_vectorsize, m_divisor));
+        }
+    }
+    
+    void DspChain::connect()
+    {
+        // The inputs read the vectors of their links in the order of the schedule,
+        // so the arrays are read from the beginning to the end during a vector.
+        ulong size = 0;
+        for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
+        {
+            for(ulong j = 0; j < m_schedule[i]->getNumberOfInputs(); j++)
+            {
+                size += m_schedule[i]->m_inputs[j].getNumberOfVectors();
+            }
+        }
+        m_sources.assign(size, nullptr);
+        m_dsources.assign(size, nullptr);
+        m_bindings.assign(size, nullptr);
+        m_channels.assign(size, 0);
         
-        m_running = true;
+        ulong first = 0;
+        for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
+        {
+            DspNode& node = *m_schedule[i];
+            for(ulong j = 0; j < node.getNumberOfInputs(); j++)
+            {
+                node.m_inputs[j].connect(node, m_sources.data() + first, m_dsources.data() + first, m_bindings.data() + first, m_channels.data() + first);
+                first += node.m_inputs[j].getNumberOfVectors();
+            }
+        }
     }
     
     void DspChain::stop()
     {
+        lock_guard<mutex> compiling(m_compile);
         if(m_running)
         {
             m_running = false;
             lock_guard<mutex> guard(m_mutex);
-            for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
+            for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
             {
-                m_nodes[i]->stop();
+                m_schedule[i]->stop();
             }
+            m_sources.clear();
+            m_dsources.clear();
+            m_bindings.clear();
+            m_channels.clear();
         }
     }
     
@@ -276,9 +1157,11 @@ namespace Kiwi
     {
         if(state && !m_running)
         {
+            // The chain is compiled again in the same way it was.
+            lock_guard<mutex> compiling(m_compile);
             try
             {
-                start();
+                build();
             }
             catch(DspError& e)
             {
@@ -25,6 +25,7 @@
 #define __DEF_KIWI_DSP_CHAIN__
 
 #include "DspNode.h"
+#include <future>
 
 // TODO :
 // - Check thread safety
@@ -39,33 +40,178 @@ namespace Kiwi
     
     //! The dsp chain manages a set of dsp nodes.
     /**
-     The dsp chain initializes a dsp chain with a set of nodes and links. To create a dsp chain, first, you should add the nodes, then add the links, then you have to compile the dsp chain.
+     The dsp chain initializes a dsp chain with a set of nodes and links. To create a dsp chain, first, you should add the nodes, then add the links, then you have to compile the dsp chain. The changes of the parameters of the nodes are posted by one control thread in a lock-free queue with a time in samples and dispatched by the audio thread at the beginning of the vector where they occur. By default, the chain performs the vectors of its context but it can declare its own vector size and divide the sample rate, then a bridge buffers the inputs and the outputs of the device, averages the inputs and interpolates the outputs linearly at the boundaries of the chain.
      */
     class DspChain: public inheritable_enable_shared_from_this<DspChain>
     {
         friend DspContext;
         
     private:
+        class Bridge;
+        
+        struct Event
+        {
+            DspNode*        node;
+            DspParameter*   parameter;
+            sample          value;
+            ulong           time;
+        };
+        
+        struct Schedule
+        {
+            ulong               hash;
+            ulong               stamp;
+            vector<wDspNode>    nodes;
+        };
+        
+        struct Graph
+        {
+            vector<ulong>       first;
+            vector<ulong>       edges;
+        };
+        
+        static const ulong c_schedules = 16;
+        
         wDspContext         m_context;
         vector<sDspNode>    m_nodes;
+        unordered_map<const DspNode*, ulong> m_nodes_indices;
         vector<sDspLink>    m_links;
+        unordered_map<const DspLink*, ulong> m_links_indices;
+        vector<sDspNode>    m_schedule;
         mutable mutex       m_mutex;
+        mutex               m_compile;
         atomic_bool         m_running;
+        atomic_bool         m_asynchronous;
+        vector<Event>       m_events;
+        mutable atomic_ulong m_head;
+        atomic_ulong        m_tail;
+        mutable atomic_ulong m_time;
+        ulong               m_samplerate;
+        ulong               m_vectorsize;
+        ulong               m_blocksize;
+        ulong               m_divisor;
+        unique_ptr<Bridge>  m_bridge;
+        vector<Schedule>    m_schedules;
+        ulong               m_stamp;
+        vector<sample*>     m_sources;
+        vector<double*>     m_dsources;
+        vector<const sample* const*> m_bindings;
+        vector<ulong>       m_channels;
+        
+        //! Sort the nodes of a graph.
+        /** The function sorts the nodes identified by their positions so each node comes after the nodes it depends on. The edges of a node are the positions of the nodes it depends on, they are stored from the first edge of the node to the first edge of the next node. The strongly connected components of the graph are computed iteratively, the components with several nodes are the loops. The graph shouldn't have an edge from a node to itself, the links and the predecessors of a node to itself are ignored.
+         @param graph The graph of the nodes.
+         @param order The positions of the nodes sorted.
+         @param loops The positions of the nodes of each loop.
+         */
+        static void sortNodes(Graph const& graph, vector<ulong>& order, vector<vector<ulong>>& loops) noexcept;
+        
+        //! Check if a node depends on another node.
+        /** The function checks if a node is linked to another node directly or through other nodes. Only the nodes placed after the other node in an order of the graph are visited.
+         @param graph     The graph of the nodes.
+         @param positions The positions of the nodes in the order of the graph.
+         @param marks     The marks of the nodes visited.
+         @param mark      The mark of this check.
+         @param node      The node to check.
+         @param other     The other node.
+         @return True if the node depends on the other node otherwise it returns false.
+         */
+        static bool isDependent(Graph const& graph, vector<ulong> const& positions, vector<ulong>& marks, const ulong mark, const ulong node, const ulong other) noexcept;
+        
+        //! Compute the structural hash of the chain.
+        /** The function computes a hash of the nodes and the links that doesn't depend on the order in which they have been added.
+         @return The hash.
+         */
+        ulong getHash() const noexcept;
+        
+        //! Define the order of the nodes.
+        /** The function retrieves the order of the nodes from the schedules already computed for the same nodes and links, otherwise it sorts the nodes and keeps their order. The least recently used schedule is forgotten when there are too many of them.
+         */
+        void order() throw(DspError&);
+        
+        //! Compile the dsp chain.
+        /** The function sorts all the nodes and prepares them, the chain should be stopped and the compile mutex owned.
+         */
+        void build() throw(DspError&);
+        
+        //! Compile the dsp chain while it's running.
+        /** The function sorts the nodes and prepares the new ones without the mutex of the chain, then it publishes the new schedule with the mutex. The nodes whose links haven't changed keep their state and their signals, only the new nodes, the ones whose links changed and the ones whose predecessors changed or moved are prepared and allocated again. These nodes are removed from the schedule while they're prepared so the audio thread doesn't wait for them. The links of all the inputs are connected again. The compile mutex should be owned. If the nodes loop, the previous schedule keeps running.
+         */
+        void update() throw(DspError&);
+        
+        //! Prepare the bridge.
+        /** The function creates the bridge if the vector size or the sample rate of the chain differs from the ones of the context, otherwise it deletes it.
+         */
+        void prepareBridge();
+        
+        //! Connect the inputs of the nodes.
+        /** The function stores the vectors of the links of all the inputs of the schedule one after the other in the arrays of the chain and connects the inputs to them. The nodes should be prepared and the mutex owned.
+         */
+        void connect();
+        
+        //! Resize the dsp chain.
+        /** The function resizes the nodes for the current sample rate and vector size without sorting them again, it's called by the context when the device changes its configuration. If nothing changed for the chain, the nodes are kept as they are.
+         */
+        void resize() throw(DspError&);
+        
+        //! Dispatch the changes of the parameters.
+        /** The function schedules the changes that occur during the next vector in their parameters. It's called by the audio thread or by a thread that owns the mutex.
+         */
+        inline void dispatch() const noexcept
+        {
+            const ulong tail = m_tail.load(memory_order_acquire);
+            const ulong time = m_time.load(memory_order_relaxed);
+            ulong head = m_head.load(memory_order_relaxed);
+            while(head != tail)
+            {
+                Event const& event = m_events[head & (m_events.size() - 1)];
+                if(event.time >= time + m_vectorsize)
+                {
+                    break;
+                }
+                if(event.parameter)
+                {
+                    event.parameter->schedule(event.value, event.time > time ? event.time - time : 0);
+                }
+                head++;
+            }
+            m_head.store(head, memory_order_release);
+        }
+        
+        //! Perform a vector of the dsp chain.
+        /** The function dispatches the changes of the parameters and calls once all the node methods of the dsp nodes.
+         */
+        inline void perform() const noexcept
+        {
+            dispatch();
+            for(vector<sDspNode>::size_type i = 0; i < m_schedule.size(); i++)
+            {
+                if(m_schedule[i]->isRunning())
+                {
+                    m_schedule[i]->tick();
+                }
+            }
+            m_time.fetch_add(m_vectorsize, memory_order_relaxed);
+        }
         
-        void sortNodes(set<sDspNode>& nodes, ulong& index, sDspNode node) throw(DspError&);
+        //! Perform the vectors of the dsp chain through the bridge.
+        /** The function pushes the inputs of the device in the bridge, performs the vectors of the chain that are ready and adds the outputs of the bridge to the outputs of the device.
+         */
+        void bridge() const noexcept;
         
         //! Perform a tick on the dsp chain.
-        /** The function calls once all the node methods of the dsp nodes.
+        /** The function performs a vector of the chain or, if the chain has its own vector size or sample rate, the vectors of the chain that fit in the vector of the context.
          */
         inline void tick() const noexcept
         {
             lock_guard<mutex> guard(m_mutex);
-            for(vector<sDspNode>::size_type i = 0; i < m_nodes.size(); i++)
+            if(m_bridge)
             {
-                if(m_nodes[i]->isRunning())
-                {
-                    m_nodes[i]->tick();
-                }
+                bridge();
+            }
+            else
+            {
+                perform();
             }
         }
         
@@ -109,6 +255,63 @@ namespace Kiwi
          */
         ulong getVectorSize() const noexcept;
         
+        //! Set the vector size of the chain.
+        /** This function sets the vector size of the chain, zero uses the vector size of the context. A larger vector size reduces the overhead of the heavy chains, the vectors of the context are then buffered and the outputs are delayed.
+         @param vectorsize The vector size of the chain.
+         */
+        void setVectorSize(const ulong vectorsize) throw(DspError&);
+        
+        //! Retrieve the rate divisor of the chain.
+        /** This function retrieves the factor that divides the sample rate of the context.
+         @return The rate divisor of the chain.
+         */
+        inline ulong getRateDivisor() const noexcept
+        {
+            return m_divisor;
+        }
+        
+        //! Set the rate divisor of the chain.
+        /** This function sets the factor that divides the sample rate of the context. The inputs of the device are averaged and the outputs are interpolated linearly. A chain with a vector size of one and the vector size of the context as divisor performs one value per vector of the context at control rate.
+         @param divisor The rate divisor of the chain.
+         */
+        void setRateDivisor(const ulong divisor) throw(DspError&);
+        
+        //! Check if the chain is bridged.
+        /** This function checks if the chain performs its own vectors through a bridge because its vector size or its sample rate differs from the ones of the context.
+         @return True if the chain is bridged.
+         */
+        inline bool isBridged() const noexcept
+        {
+            return bool(m_bridge);
+        }
+        
+        //! Retrieve the latency of the chain.
+        /** This function retrieves the number of samples of the context that the outputs of the chain are delayed by the bridge.
+         @return The latency in samples.
+         */
+        ulong getLatency() const noexcept;
+        
+        //! Retrieve the binding of an input channel of the bridge.
+        /** This function retrieves the address of the pointer to the samples of an input channel of the device at the vector size and the sample rate of the chain, it should be used by the nodes of a bridged chain instead of the inputs of the device.
+         @param channel The index of the channel.
+         @return The address of the pointer to the samples or nullptr if the chain isn't bridged.
+         */
+        sample const* const* getInputsBinding(const ulong channel) const noexcept;
+        
+        //! Retrieve the binding of an output channel of the bridge.
+        /** This function retrieves the address of the pointer to the samples of an output channel of the device at the vector size and the sample rate of the chain, it should be used by the nodes of a bridged chain instead of the outputs of the device.
+         @param channel The index of the channel.
+         @return The address of the pointer to the samples or nullptr if the chain isn't bridged.
+         */
+        sample* const* getOutputsBinding(const ulong channel) const noexcept;
+        
+        //! Claim an output channel of the bridge for the current vector.
+        /** The function marks an output channel of the bridge as written during the current vector of the chain. If the function returns true, the node is the first one that writes the channel and it should copy its samples, otherwise it should add its samples.
+         @param channel The index of the channel.
+         @return True if the channel hasn't been written yet.
+         */
+        bool claimOutput(const ulong channel) const noexcept;
+        
         //! Check if the chain is compiled.
         /** This function checks if the chain is compiled.
          @return True if the chain is compiled otherwise it returns false.
@@ -118,6 +321,24 @@ namespace Kiwi
             return m_running;
         }
         
+        //! Retrieve the time of the chain.
+        /** This function retrieves the number of samples performed by the chain, it's the time of the beginning of the next vector.
+         @return The time of the chain in samples.
+         */
+        inline ulong getTime() const noexcept
+        {
+            return m_time.load(memory_order_relaxed);
+        }
+        
+        //! Post a change of a parameter.
+        /** The function posts a change of a parameter of a node, that is applied at a time of the chain. The changes should be posted by one thread in the order of their times, a time in the past is applied at the beginning of the next vector. If the queue is full, the pending changes are applied immediately.
+         @param node      The node that owns the parameter.
+         @param parameter The parameter.
+         @param value     The new value.
+         @param time      The time in samples.
+         */
+        void post(DspNode* node, DspParameter* parameter, const sample value, const ulong time) noexcept;
+        
         //! Retrieve the number of nodes.
         /** The function retrieves the number of nodes.
          @return The number of nodes.
@@ -157,6 +378,12 @@ namespace Kiwi
          */
         void start() throw(DspError&);
         
+        //! Compile the dsp chain asynchronously.
+        /** The function compiles the dsp chain on a background thread. If the chain is running, the current schedule keeps playing until the new one is ready, only the new nodes and the nodes whose links changed are prepared and the new nodes are prepared without blocking the audio thread. Once the chain has been compiled asynchronously, adding or removing nodes and links doesn't stop it anymore and the changes are applied by the next compilation, until the chain is started synchronously.
+         @return The future of the compilation that throws the error of the compilation if any.
+         */
+        future<void> compile();
+        
         //! Stop the dsp.
         /** The function call the stop the dsp of all the nodes.
          */
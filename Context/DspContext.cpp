@@ -45,6 +45,7 @@ namespace Kiwi
             stop();
         }
         m_chains.clear();
+        m_chains_indices.clear();
     }
     
     ulong DspContext::getSampleRate() const noexcept
@@ -65,7 +66,7 @@ namespace Kiwi
         sDspDeviceManager device = getDeviceManager();
         if(device)
         {
-            return device->getVectorSize();
+            return device->getBlockSize();
         }
         else
         {
@@ -78,10 +79,7 @@ namespace Kiwi
         if(chain)
         {
             lock_guard<mutex> guard(m_mutex);
-            if(find(m_chains.begin(), m_chains.end(), chain) == m_chains.end())
-            {
-                m_chains.push_back(chain);
-            }
+            insertIndexed(m_chains, m_chains_indices, chain);
         }
     }
     
@@ -91,12 +89,7 @@ namespace Kiwi
         if(chain)
         {
             lock_guard<mutex> guard(m_mutex);
-            auto it = find(m_chains.begin(), m_chains.end(), chain);
-            if(it != m_chains.end())
-            {
-                m_chains.erase(it);
-                finded = true;
-            }
+            finded = eraseIndexed(m_chains, m_chains_indices, chain);
         }
         if(finded && m_running)
         {
@@ -119,6 +112,29 @@ namespace Kiwi
         }
     }
     
+    void DspContext::resize()
+    {
+        if(m_running)
+        {
+            lock_guard<mutex> guard(m_mutex);
+            for(vector<sDspChain>::size_type i = 0; i < m_chains.size(); i++)
+            {
+                if(m_chains[i]->isRunning())
+                {
+                    try
+                    {
+                        m_chains[i]->resize();
+                    }
+                    catch(DspError& e)
+                    {
+                        m_chains[i]->stop();
+                    }
+                }
+            }
+            m_cpu_factor = 10e-6 * (double)getSampleRate() / (double)getVectorSize();
+        }
+    }
+    
     void DspContext::stop()
     {
         if(m_running)
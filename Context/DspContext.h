@@ -43,6 +43,7 @@ namespace Kiwi
     private:
         const wDspDeviceManager m_device;
         vector<sDspChain>       m_chains;
+        unordered_map<const DspChain*, ulong> m_chains_indices;
         mutable mutex           m_mutex;
         mutable double          m_cpu;
         double                  m_cpu_factor;
@@ -66,6 +67,11 @@ namespace Kiwi
             m_cpu = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
         }
         
+        //! Resize the dsp context.
+        /** The function resizes the running chains for the current sample rate and vector size of the device without compiling them again. A chain that can't be resized is stopped.
+         */
+        void resize();
+        
     public:
         
         //! The constructor.
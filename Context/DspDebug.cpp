@@ -0,0 +1,315 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspDebug.h"
+
+#ifdef __KIWI_DSP_DEBUG__
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#if defined(__unix__) || defined(__APPLE__)
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <cerrno>
+#define __KIWI_DSP_INTERPOSE__
+#endif
+#endif
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                  REAL-TIME CHECKER                               //
+    // ================================================================================ //
+
+#ifdef __KIWI_DSP_DEBUG__
+    
+#ifdef __KIWI_DSP_INTERPOSE__
+    // The initial exec model doesn't allocate the variables when they're used by malloc.
+    static thread_local bool    realtime_thread __attribute__((tls_model("initial-exec"))) = false;
+    static thread_local bool    realtime_allowed __attribute__((tls_model("initial-exec"))) = false;
+#else
+    static thread_local bool    realtime_thread = false;
+    static thread_local bool    realtime_allowed = false;
+#endif
+    static atomic_int           realtime_mode(RealTimeChecker::Record);
+    static atomic_ulong         realtime_violations[3];
+    
+    RealTimeChecker::Scope::Scope() noexcept :
+    m_previous(realtime_thread)
+    {
+        realtime_thread = true;
+    }
+    
+    RealTimeChecker::Scope::~Scope() noexcept
+    {
+        realtime_thread = m_previous;
+    }
+    
+    RealTimeChecker::Allow::Allow() noexcept :
+    m_previous(realtime_allowed)
+    {
+        realtime_allowed = true;
+    }
+    
+    RealTimeChecker::Allow::~Allow() noexcept
+    {
+        realtime_allowed = m_previous;
+    }
+    
+    bool RealTimeChecker::isRealTime() noexcept
+    {
+        return realtime_thread && !realtime_allowed;
+    }
+    
+    void RealTimeChecker::report(const Violation violation) noexcept
+    {
+        if(!isRealTime())
+        {
+            return;
+        }
+        realtime_violations[violation]++;
+        if(realtime_mode == Abort)
+        {
+            // The checks are suspended because printing the stack allocates and writes.
+            realtime_allowed = true;
+            static const char* names[3] = {"allocation", "lock", "system call"};
+            fprintf(stderr, "Kiwi: %s in the audio thread\n", names[violation]);
+#if defined(__unix__) || defined(__APPLE__)
+            void* frames[64];
+            backtrace_symbols_fd(frames, backtrace(frames, 64), STDERR_FILENO);
+#endif
+            abort();
+        }
+    }
+    
+    void RealTimeChecker::setMode(const Mode mode) noexcept
+    {
+        realtime_mode = mode;
+    }
+    
+    ulong RealTimeChecker::getNumberOfViolations(const Violation violation) noexcept
+    {
+        return realtime_violations[violation];
+    }
+    
+    void RealTimeChecker::reset() noexcept
+    {
+        for(ulong i = 0; i < 3; i++)
+        {
+            realtime_violations[i] = 0;
+        }
+    }
+
+#else
+    
+    bool RealTimeChecker::isRealTime() noexcept
+    {
+        return false;
+    }
+    
+    void RealTimeChecker::report(const Violation) noexcept
+    {
+        ;
+    }
+    
+    void RealTimeChecker::setMode(const Mode) noexcept
+    {
+        ;
+    }
+    
+    ulong RealTimeChecker::getNumberOfViolations(const Violation) noexcept
+    {
+        return 0;
+    }
+    
+    void RealTimeChecker::reset() noexcept
+    {
+        ;
+    }
+
+#endif
+}
+
+#ifdef __KIWI_DSP_DEBUG__
+
+// ================================================================================ //
+//                                  INTERPOSITION                                   //
+// ================================================================================ //
+
+#ifdef __KIWI_DSP_INTERPOSE__
+
+// The operators new and delete of the standard library use malloc and free.
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void  __libc_free(void* ptr);
+    
+    void* malloc(size_t size)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Allocation);
+        return __libc_malloc(size);
+    }
+    
+    void* calloc(size_t count, size_t size)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Allocation);
+        return __libc_calloc(count, size);
+    }
+    
+    void* realloc(void* ptr, size_t size)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Allocation);
+        return __libc_realloc(ptr, size);
+    }
+    
+    void free(void* ptr)
+    {
+        if(ptr)
+        {
+            Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Allocation);
+        }
+        __libc_free(ptr);
+    }
+    
+    ssize_t __read(int fd, void* buffer, size_t size);
+    ssize_t __write(int fd, const void* buffer, size_t size);
+    int     __nanosleep(const timespec* request, timespec* remain);
+    size_t  _IO_fwrite(const void* buffer, size_t size, size_t count, FILE* stream);
+    int     _IO_putc(int c, FILE* stream);
+    int     _IO_fflush(FILE* stream);
+    
+    // The next pthread_mutex_lock is retrieved when the library is loaded, because dlsym
+    // can lock a mutex. Before, the mutexes are locked by polling.
+    static int (*pthread_mutex_lock_next)(pthread_mutex_t*) = nullptr;
+    
+    __attribute__((constructor)) static void pthread_mutex_lock_init()
+    {
+        pthread_mutex_lock_next = (int (*)(pthread_mutex_t*))dlsym(RTLD_NEXT, "pthread_mutex_lock");
+    }
+    
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        // The mutexes that are free don't wait, only the others are violations.
+        if(Kiwi::RealTimeChecker::isRealTime())
+        {
+            if(!pthread_mutex_trylock(mutex))
+            {
+                return 0;
+            }
+            Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Lock);
+        }
+        if(pthread_mutex_lock_next)
+        {
+            return pthread_mutex_lock_next(mutex);
+        }
+        int err;
+        while((err = pthread_mutex_trylock(mutex)) == EBUSY)
+        {
+            sched_yield();
+        }
+        return err;
+    }
+    
+    ssize_t read(int fd, void* buffer, size_t size)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Syscall);
+        return __read(fd, buffer, size);
+    }
+    
+    ssize_t write(int fd, const void* buffer, size_t size)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Syscall);
+        return __write(fd, buffer, size);
+    }
+    
+    int nanosleep(const timespec* request, timespec* remain)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Syscall);
+        return __nanosleep(request, remain);
+    }
+    
+    // The streams of the standard libraries write with the internal functions of the c library.
+    size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Syscall);
+        return _IO_fwrite(buffer, size, count, stream);
+    }
+    
+    int putc(int c, FILE* stream)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Syscall);
+        return _IO_putc(c, stream);
+    }
+    
+    int fflush(FILE* stream)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Syscall);
+        return _IO_fflush(stream);
+    }
+}
+
+#else
+
+// Without the interposition of malloc and free, only the operators new and delete are checked.
+void* operator new(size_t size)
+{
+    Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Allocation);
+    void* ptr = malloc(size ? size : 1);
+    if(!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if(ptr)
+    {
+        Kiwi::RealTimeChecker::report(Kiwi::RealTimeChecker::Allocation);
+    }
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+#endif
+
+#endif
+
@@ -0,0 +1,128 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_DEBUG__
+#define __DEF_KIWI_DSP_DEBUG__
+
+#include "DspSignal.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                  REAL-TIME CHECKER                               //
+    // ================================================================================ //
+    
+    //! The real-time checker detects the operations that shouldn't be done by the audio thread.
+    /**
+     The real-time checker marks the threads that perform the dsp and, when the library is compiled with __KIWI_DSP_DEBUG__, detects the allocations, the mutexes that have to wait and the blocking system calls done by these threads. With the gnu c library, the malloc, calloc, realloc, free, pthread_mutex_lock, read, write, nanosleep and stdio output functions are interposed, so the operators new and delete of the standard library are checked through malloc and free. With the other libraries, only the global operators new and delete are replaced. A violation is recorded or, in the abort mode, the stack is printed and the program is aborted. Without __KIWI_DSP_DEBUG__, nothing is checked and the marking of the threads costs nothing.
+     */
+    class RealTimeChecker
+    {
+    public:
+        
+        //! The violations.
+        enum Violation
+        {
+            Allocation  = 0, ///< An allocation or a deallocation.
+            Lock        = 1, ///< A mutex that has to wait.
+            Syscall     = 2  ///< A blocking system call.
+        };
+        
+        //! The modes.
+        enum Mode
+        {
+            Record      = 0, ///< The violations are counted.
+            Abort       = 1  ///< The stack is printed and the program is aborted.
+        };
+        
+        //! The scope marks the current thread as real-time.
+        /**
+         The scope marks the current thread as real-time when it's created and restores the previous status when it's destroyed.
+         */
+        class Scope
+        {
+#ifdef __KIWI_DSP_DEBUG__
+        private:
+            const bool m_previous;
+        public:
+            Scope() noexcept;
+            ~Scope() noexcept;
+#else
+        public:
+            inline Scope() noexcept {}
+#endif
+        };
+        
+        //! The scope allows the operations in the real-time threads.
+        /**
+         The scope suspends the checks of the current thread when it's created and restores them when it's destroyed, for the code that is known to be safe.
+         */
+        class Allow
+        {
+#ifdef __KIWI_DSP_DEBUG__
+        private:
+            const bool m_previous;
+        public:
+            Allow() noexcept;
+            ~Allow() noexcept;
+#else
+        public:
+            inline Allow() noexcept {}
+#endif
+        };
+        
+        //! Check if the current thread is real-time.
+        /** The function checks if the current thread is marked as real-time and if the checks are active.
+         @return True if the current thread is real-time.
+         */
+        static bool isRealTime() noexcept;
+        
+        //! Report a violation.
+        /** The function records a violation if the current thread is real-time, or prints the stack and aborts in the abort mode.
+         @param violation The violation.
+         */
+        static void report(const Violation violation) noexcept;
+        
+        //! Set the mode.
+        /** The function sets if the violations are recorded or abort the program.
+         @param mode The mode.
+         */
+        static void setMode(const Mode mode) noexcept;
+        
+        //! Retrieve the number of violations.
+        /** The function retrieves the number of violations of a kind since the last reset.
+         @param violation The violation.
+         @return The number of violations.
+         */
+        static ulong getNumberOfViolations(const Violation violation) noexcept;
+        
+        //! Reset the number of violations.
+        /** The function resets the number of violations of all the kinds.
+         */
+        static void reset() noexcept;
+    };
+}
+
+#endif
+
+
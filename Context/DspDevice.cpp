@@ -22,6 +22,13 @@
 */
 
 #include "DspDevice.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
 
 namespace Kiwi
 {
@@ -29,7 +36,90 @@ namespace Kiwi
     //                                      DSP DEVICE                                  //
     // ================================================================================ //
     
-    DspDeviceManager::DspDeviceManager() noexcept
+    ulong DspDeviceManager::RealTime::apply() const noexcept
+    {
+        ulong failures = None;
+#if defined(__unix__) || defined(__APPLE__)
+        if(policy != Default)
+        {
+            sched_param param;
+            param.sched_priority = priority;
+            if(pthread_setschedparam(pthread_self(), policy == Fifo ? SCHED_FIFO : SCHED_RR, &param))
+            {
+                failures |= Scheduling;
+            }
+        }
+#ifdef __linux__
+        if(!processors.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for(vector<ulong>::size_type i = 0; i < processors.size(); i++)
+            {
+                if(processors[i] < CPU_SETSIZE)
+                {
+                    CPU_SET(processors[i], &set);
+                }
+            }
+            if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set))
+            {
+                failures |= Affinity;
+            }
+        }
+#else
+        if(!processors.empty())
+        {
+            failures |= Affinity;
+        }
+#endif
+#else
+        if(policy != Default)
+        {
+            failures |= Scheduling;
+        }
+        if(!processors.empty())
+        {
+            failures |= Affinity;
+        }
+#endif
+        return failures;
+    }
+    
+    ulong DspDeviceManager::RealTime::lockMemory() const noexcept
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if(lock)
+        {
+            // The future pages are locked too, so a limit of locked memory would make the
+            // next allocations fail. The memory is only locked without limit or by root.
+            rlimit limit;
+            if(geteuid() && (getrlimit(RLIMIT_MEMLOCK, &limit) || limit.rlim_cur != RLIM_INFINITY))
+            {
+                limit.rlim_cur = limit.rlim_max = RLIM_INFINITY;
+                if(setrlimit(RLIMIT_MEMLOCK, &limit))
+                {
+                    return Memory;
+                }
+            }
+            return mlockall(MCL_CURRENT | MCL_FUTURE) ? Memory : None;
+        }
+        else
+        {
+            munlockall();
+            return None;
+        }
+#else
+        return lock ? Memory : None;
+#endif
+    }
+    
+    DspDeviceManager::DspDeviceManager() noexcept :
+    m_denormals(true),
+    m_realtime_stamp(0),
+    m_realtime_applied(0),
+    m_realtime_failures(0),
+    m_cycle(0),
+    m_blocksize(0)
     {
         ;
     }
@@ -38,17 +128,50 @@ namespace Kiwi
     {
         lock_guard<mutex> guard(m_mutex);
         m_contexts.clear();
+        m_contexts_indices.clear();
     }
     
-    void DspDeviceManager::add(sDspContext context)
+    void DspDeviceManager::prepareOutputs(const ulong noutputs)
     {
-        if(context)
+        lock_guard<mutex> guard(m_mutex);
+        m_written.assign(noutputs, 0);
+        m_cycle = 0;
+    }
+    
+    void DspDeviceManager::prepareBlocks(const ulong ninputs, const ulong noutputs)
+    {
+        lock_guard<mutex> guard(m_mutex);
+        m_reblocker.prepare(ninputs, noutputs, getBlockSize(), getVectorSize());
+    }
+    
+    future<void> DspDeviceManager::resize()
+    {
+        // The contexts are copied so the device isn't locked while the nodes are prepared.
+        vector<sDspContext> contexts;
         {
             lock_guard<mutex> guard(m_mutex);
-            if(find(m_contexts.begin(), m_contexts.end(), context) == m_contexts.end())
+            contexts = m_contexts;
+        }
+        return async(launch::async, [contexts]()
+        {
+            for(vector<sDspContext>::size_type i = 0; i < contexts.size(); i++)
             {
-                m_contexts.push_back(context);
+                contexts[i]->resize();
             }
+        });
+    }
+    
+    void DspDeviceManager::setBlockSize(ulong const blocksize)
+    {
+        m_blocksize = blocksize;
+    }
+    
+    void DspDeviceManager::add(sDspContext context)
+    {
+        if(context)
+        {
+            lock_guard<mutex> guard(m_mutex);
+            insertIndexed(m_contexts, m_contexts_indices, context);
         }
     }
     
@@ -57,14 +180,31 @@ namespace Kiwi
         if(context)
         {
             lock_guard<mutex> guard(m_mutex);
-            auto it = find(m_contexts.begin(), m_contexts.end(), context);
-            if(it != m_contexts.end())
-            {
-                m_contexts.erase(it);
-            }
+            eraseIndexed(m_contexts, m_contexts_indices, context);
         }
     }
     
+    void DspDeviceManager::setRealTime(RealTime const& settings)
+    {
+        // The vectors of the chains are cleared when they're allocated so their pages are
+        // already mapped, locking the memory keeps them in the physical memory.
+        ulong failures = RealTime::None;
+        if(settings.lock || getRealTime().lock)
+        {
+            failures = settings.lockMemory();
+        }
+        lock_guard<mutex> guard(m_mutex);
+        m_realtime          = settings;
+        m_realtime_failures = failures;
+        m_realtime_stamp++;
+    }
+    
+    DspDeviceManager::RealTime DspDeviceManager::getRealTime() const
+    {
+        lock_guard<mutex> guard(m_mutex);
+        return m_realtime;
+    }
+    
     bool DspDeviceManager::isDriverAvailable(string const& driver) const
     {
         vector<string> drivers;
@@ -25,6 +25,8 @@
 #define __DEF_KIWI_DSP_DEVICE__
 
 #include "DspContext.h"
+#include "DspDebug.h"
+#include "DspReblocker.h"
 
 namespace Kiwi
 {
@@ -34,18 +36,95 @@ namespace Kiwi
      */
     class DspDeviceManager
     {
+    public:
+        
+        //! The real-time settings of the threads.
+        /**
+         The real-time settings define the scheduling policy, the priority and the processors of the threads that perform the dsp, and if the memory of the process is locked in the physical memory. The scheduling and the processors are managed on the posix systems and the processors only on linux, the failures are reported and never stop the dsp.
+         */
+        class RealTime
+        {
+        public:
+            
+            //! The scheduling policies.
+            enum Policy
+            {
+                Default     = 0, ///< The scheduling of the thread isn't changed.
+                Fifo        = 1, ///< The first in first out real-time scheduling.
+                RoundRobin  = 2  ///< The round robin real-time scheduling.
+            };
+            
+            //! The failures.
+            enum Failure
+            {
+                None        = 0, ///< Nothing failed.
+                Scheduling  = 1, ///< The policy or the priority couldn't be set.
+                Affinity    = 2, ///< The processors couldn't be set.
+                Memory      = 4  ///< The memory couldn't be locked.
+            };
+            
+            Policy          policy;     ///< The scheduling policy.
+            int             priority;   ///< The priority of the real-time scheduling.
+            vector<ulong>   processors; ///< The processors the threads can run on, all of them if empty.
+            bool            lock;       ///< If the memory should be locked.
+            
+            //! Constructor.
+            /** The default settings don't change anything.
+             */
+            RealTime() noexcept :
+            policy(Default),
+            priority(0),
+            lock(false)
+            {
+                ;
+            }
+            
+            //! Apply the scheduling and the processors to the current thread.
+            /** The function sets the scheduling policy, the priority and the processors of the current thread. It doesn't allocate and can be called by the audio thread.
+             @return The failures.
+             */
+            ulong apply() const noexcept;
+            
+            //! Lock or unlock the memory.
+            /** The function locks the current and the future pages of the process in the physical memory, or unlocks them.
+             @return The failures.
+             */
+            ulong lockMemory() const noexcept;
+        };
+        
     private:
         vector<sDspContext> m_contexts;
+        unordered_map<const DspContext*, ulong> m_contexts_indices;
         mutable mutex       m_mutex;
+        atomic_bool         m_denormals;
+        RealTime            m_realtime;
+        atomic_ulong        m_realtime_stamp;
+        mutable atomic_ulong m_realtime_applied;
+        mutable atomic_ulong m_realtime_failures;
+        mutable thread::id  m_realtime_thread;
+        mutable vector<ulong> m_written;
+        mutable ulong       m_cycle;
+        atomic_ulong        m_blocksize;
+        mutable DspReblocker m_reblocker;
         
     protected:
         
         //! The tick function to call at each dsp cycle.
-        /** The function ticks all the contexts.
+        /** The function ticks all the contexts. If the denormals should be flushed, the flush modes are set during the tick and the previous modes of the thread are restored after. The thread is marked as real-time during the tick for the real-time checker.
          */
         inline void tick() const noexcept
         {
+            RealTimeChecker::Scope realtime;
+            Denormals denormals(m_denormals);
             lock_guard<mutex> guard(m_mutex);
+            m_cycle++;
+            if(m_realtime_applied != m_realtime_stamp || m_realtime_thread != this_thread::get_id())
+            {
+                // The settings are applied once per thread, the backend can change the thread.
+                m_realtime_thread   = this_thread::get_id();
+                m_realtime_applied  = (ulong)m_realtime_stamp;
+                m_realtime_failures |= m_realtime.apply();
+            }
             for(vector<sDspContext>::size_type i = 0; i < m_contexts.size(); i++)
             {
                 if(m_contexts[i]->isRunning())
@@ -55,6 +134,78 @@ namespace Kiwi
             }
         }
         
+        //! Prepare the tracking of the outputs.
+        /** The function allocates the states of the output channels so the nodes track the channels they write during each dsp cycle. Then the device doesn't have to clear its output buffers before the cycle, but it should clear the channels that haven't been written after the cycle. It should be called when the audio stream is stopped.
+         @param noutputs The number of output channels.
+         */
+        void prepareOutputs(const ulong noutputs);
+        
+        //! Check if an output channel has been written.
+        /** The function checks if a node has written an output channel during the current dsp cycle.
+         @param channel The index of the channel.
+         @return True if the channel has been written.
+         */
+        inline bool isOutputWritten(const ulong channel) const noexcept
+        {
+            return channel < m_written.size() && m_written[channel] == m_cycle;
+        }
+        
+        //! Prepare the reblocking.
+        /** The function allocates the buffers of the blocks and the rings between the buffers of the host and the blocks for the current block size and vector size, and computes the latency. It should be called when the audio stream is stopped.
+         @param ninputs  The number of input channels.
+         @param noutputs The number of output channels.
+         */
+        void prepareBlocks(const ulong ninputs, const ulong noutputs);
+        
+        //! Resize the contexts.
+        /** The function resizes the running contexts for the current sample rate and vector size in a background task, the nodes keep their order, their links and their states so the switch is much faster than a restart of the dsp. It should be called when the audio stream is stopped, and the stream should be started again once the task is done, meanwhile the device can reopen the stream of the host.
+         @return The future of the task.
+         */
+        future<void> resize();
+        
+        //! Retrieve the input buffer of a channel of the block.
+        /** The function retrieves the samples of an input channel that the nodes read during a block when the device performs the blocks with the reblocking.
+         @param channel The index of the channel.
+         @return The samples or nullptr.
+         */
+        inline sample* getBlockInputs(const ulong channel) const noexcept
+        {
+            return m_reblocker.getInputs(channel);
+        }
+        
+        //! Retrieve the output buffer of a channel of the block.
+        /** The function retrieves the samples of an output channel that the nodes write during a block when the device performs the blocks with the reblocking.
+         @param channel The index of the channel.
+         @return The samples or nullptr.
+         */
+        inline sample* getBlockOutputs(const ulong channel) const noexcept
+        {
+            return m_reblocker.getOutputs(channel);
+        }
+        
+        //! Perform the buffers of the host with the reblocking.
+        /** The function pushes the buffers of the host in the rings, ticks the contexts for each block that is ready, clears the outputs of the block that haven't been written and retrieves the buffers of the host. The buffers of the host can have any size.
+         @param size     The number of samples of the buffers of the host.
+         @param ninputs  The number of input channels of the host.
+         @param inputs   The input channels of the host.
+         @param noutputs The number of output channels of the host.
+         @param outputs  The output channels of the host.
+         */
+        template <class Type> inline void process(const ulong size, const ulong ninputs, const Type* const* inputs, const ulong noutputs, Type* const* outputs) const noexcept
+        {
+            m_reblocker.process(size, ninputs, inputs, noutputs, outputs, [this]()
+            {
+                tick();
+                for(ulong i = 0; i < m_reblocker.getNumberOfOutputs(); i++)
+                {
+                    if(!isOutputWritten(i))
+                    {
+                        Signal::vclear(m_reblocker.getBlockSize(), m_reblocker.getOutputs(i));
+                    }
+                }
+            });
+        }
+        
     public:
         
         //! The constructor.
@@ -204,6 +355,31 @@ namespace Kiwi
          */
         virtual void setVectorSize(ulong const vectorsize) = 0;
         
+        //! Retrieve the block size.
+        /** This function retrieves the size of the vectors that the contexts perform. By default, it's the vector size of the device.
+         @return The block size.
+         */
+        inline ulong getBlockSize() const
+        {
+            const ulong blocksize = m_blocksize;
+            return blocksize ? blocksize : getVectorSize();
+        }
+        
+        //! Set the block size.
+        /** This function sets the size of the vectors that the contexts perform whatever the vector size of the device. A block size smaller than the vector size reduces the latency of the nodes that work by block, a larger block size reduces the overhead of the ticks. If the vector size isn't a multiple of the block size, the blocks are buffered and the outputs are delayed. The devices apply the block size when they restart, zero uses the vector size of the device.
+         @param blocksize The block size.
+         */
+        virtual void setBlockSize(ulong const blocksize);
+        
+        //! Retrieve the latency of the reblocking.
+        /** This function retrieves the number of samples that the outputs are delayed because the blocks are buffered. The latency is zero if the vector size is a multiple of the block size, and it can grow if the host changes the size of its buffers.
+         @return The latency in samples.
+         */
+        inline ulong getLatency() const noexcept
+        {
+            return m_reblocker.getLatency();
+        }
+        
         //! Retrieve the inputs sample matrix.
         /** This function retrieves the inputs sample matrix.
          @param channel the index of the channel.
@@ -218,6 +394,41 @@ namespace Kiwi
          */
         virtual sample* getOutputsSamples(const ulong channel) const noexcept = 0;
         
+        //! Retrieve the binding of an input channel.
+        /** This function retrieves the address of the pointer to the samples of an input channel if the device changes the pointer at each cycle, for example to use the buffers of the host directly. The nodes that read the inputs should then retrieve the pointer at each cycle. By default, the pointers don't change and the function returns nullptr.
+         @param channel the index of the channel.
+         @return The address of the pointer to the samples or nullptr.
+         */
+        virtual sample const* const* getInputsBinding(const ulong) const noexcept
+        {
+            return nullptr;
+        }
+        
+        //! Retrieve the binding of an output channel.
+        /** This function retrieves the address of the pointer to the samples of an output channel if the device changes the pointer at each cycle, for example to use the buffers of the host directly. The nodes that write the outputs should then retrieve the pointer at each cycle. By default, the pointers don't change and the function returns nullptr.
+         @param channel the index of the channel.
+         @return The address of the pointer to the samples or nullptr.
+         */
+        virtual sample* const* getOutputsBinding(const ulong) const noexcept
+        {
+            return nullptr;
+        }
+        
+        //! Claim an output channel for the current dsp cycle.
+        /** The function marks an output channel as written during the current dsp cycle, it's called by the nodes that write the outputs. If the function returns true, the node is the first one that writes the channel and it should copy its samples, otherwise it should add its samples. If the device doesn't track its outputs, the function always returns false and the device clears its outputs before the cycle.
+         @param channel The index of the channel.
+         @return True if the channel hasn't been written yet.
+         */
+        inline bool claimOutput(const ulong channel) const noexcept
+        {
+            if(channel < m_written.size() && m_written[channel] != m_cycle)
+            {
+                m_written[channel] = m_cycle;
+                return true;
+            }
+            return false;
+        }
+        
         //! Add a context to the device manager.
         /** The function adds a context to the device manager.
          @param context The context to add.
@@ -239,6 +450,54 @@ namespace Kiwi
             lock_guard<mutex> guard(m_mutex);
             return (ulong)m_contexts.size();
         }
+        
+        //! Set if the denormals should be flushed to zero.
+        /** The function sets if the denormal numbers are flushed to zero during each dsp cycle. The denormals are flushed by default.
+         @param status The flush status.
+         */
+        inline void setDenormalsFlushing(const bool status) noexcept
+        {
+            m_denormals = status;
+        }
+        
+        //! Check if the denormals are flushed to zero.
+        /** The function checks if the denormal numbers are flushed to zero during each dsp cycle.
+         @return True if the denormals are flushed to zero.
+         */
+        inline bool isFlushingDenormals() const noexcept
+        {
+            return m_denormals;
+        }
+        
+        //! Set the real-time settings of the threads.
+        /** The function sets the real-time settings. The memory is locked or unlocked immediately and the scheduling is applied to the audio thread at the next dsp cycle.
+         @param settings The real-time settings.
+         */
+        void setRealTime(RealTime const& settings);
+        
+        //! Retrieve the real-time settings of the threads.
+        /** The function retrieves the real-time settings.
+         @return The real-time settings.
+         */
+        RealTime getRealTime() const;
+        
+        //! Retrieve the failures of the real-time settings.
+        /** The function retrieves the failures that occured since the real-time settings have been set, as a combination of the RealTime::Failure flags.
+         @return The failures.
+         */
+        inline ulong getRealTimeFailures() const noexcept
+        {
+            return m_realtime_failures;
+        }
+        
+        //! Report the failures of the real-time settings in another thread.
+        /** The function adds failures to the ones retrieved by getRealTimeFailures. It's used by the threads of the nodes that apply the real-time settings of the device manager.
+         @param failures The failures as a combination of the RealTime::Failure flags.
+         */
+        inline void reportRealTimeFailures(const ulong failures) const noexcept
+        {
+            m_realtime_failures |= failures;
+        }
     };
 }
 
@@ -44,11 +44,12 @@ namespace Kiwi
             Recopy     = 0, ///< Indicates that an node can't find the signal of an input link to recopy.
             Inplace    = 1, ///< Indicates that an output can't find the input signal for inplace processing.
             Alloc      = 2, ///< Indicates that the a signal has not been allocated.
-            Loop       = 3, ///< Indicates a loop between two nodes.
+            Loop       = 3, ///< Indicates one or several loops between nodes.
         };
     private:
-        const Type      m_type;
-        const wDspNode  m_node;
+        const Type                      m_type;
+        const wDspNode                  m_node;
+        const vector<vector<wDspNode>>  m_loops;
     public:
         
         //! Constructor.
@@ -60,6 +61,19 @@ namespace Kiwi
         {
             ;
         }
+        
+        //! Constructor.
+        /** The method creates a new loop error with all the loops of a chain, the first node of the first loop is the node that generates the error.
+         @param loops   The nodes of each loop.
+         */
+        DspError(vector<vector<wDspNode>> const& loops) :
+        m_type(Loop),
+        m_node(loops.empty() || loops[0].empty() ? wDspNode() : loops[0][0]),
+        m_loops(loops)
+        {
+            ;
+        }
+        
         //! Destructor.
         /** The method does nothing.
          */
@@ -86,7 +100,7 @@ namespace Kiwi
                     return "A node can't allocate its signal.";
                     break;
                 default:
-                    return "Two nodes generate a loop.";
+                    return "Some nodes generate a loop.";
                     break;
             }
         }
@@ -108,6 +122,15 @@ namespace Kiwi
         {
             return m_node.lock();
         }
+        
+        //! Retrieve the loops that generate the error.
+        /** The method retrieves the nodes of each loop of the chain, for a loop error thrown by the sort of a chain.
+         @return The nodes of each loop.
+         */
+        inline vector<vector<wDspNode>> const& getLoops() const noexcept
+        {
+            return m_loops;
+        }
     };
 }
 
@@ -0,0 +1,225 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+
+#ifndef __DEF_KIWI_DSP_FEEDBACK__
+#define __DEF_KIWI_DSP_FEEDBACK__
+
+#include "DspSignal.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      DSP FEEDBACK                                //
+    // ================================================================================ //
+    
+    //! The dsp feedback sends values from the audio thread to a control thread.
+    /**
+     The dsp feedback is a wait-free ring buffer with one producer, the audio thread, and one consumer, a control thread, that can be used to implement meters and scopes. The audio thread pushes values or blocks of values and never waits, the values that don't fit in the ring are dropped and counted as overflows. The control thread polls the ring and retrieves the values one by one, only the latest value or a decimated stream of values.
+     */
+    template <class Type> class DspFeedback
+    {
+    private:
+        vector<Type>    m_values;
+        const ulong     m_mask;
+        atomic_ulong    m_head;
+        atomic_ulong    m_tail;
+        atomic_ulong    m_overflows;
+        ulong           m_phase;
+        
+        static inline ulong getPowerOfTwo(const ulong size) noexcept
+        {
+            ulong power = 1;
+            while(power < size)
+            {
+                power <<= 1;
+            }
+            return power;
+        }
+    
+    public:
+        
+        //! Constructor.
+        /** The function allocates the ring buffer, the size is rounded up to the next power of two.
+         @param size The number of values that the ring can store.
+         */
+        DspFeedback(const ulong size = 256) noexcept :
+        m_values(getPowerOfTwo(max(size, 1ul))),
+        m_mask(m_values.size() - 1),
+        m_head(0),
+        m_tail(0),
+        m_overflows(0),
+        m_phase(0)
+        {
+            ;
+        }
+        
+        //! Destructor.
+        ~DspFeedback()
+        {
+            ;
+        }
+        
+        //! Retrieve the size of the ring.
+        /** The function retrieves the number of values that the ring can store.
+         @return The size of the ring.
+         */
+        inline ulong getSize() const noexcept
+        {
+            return m_mask + 1;
+        }
+        
+        //! Push a value.
+        /** The function pushes a value in the ring, it should only be called by the producer. If the ring is full, the value is dropped and counted as an overflow.
+         @param value The value.
+         @return True if the value has been pushed.
+         */
+        inline bool push(Type const& value) noexcept
+        {
+            const ulong tail = m_tail.load(memory_order_relaxed);
+            if(tail - m_head.load(memory_order_acquire) > m_mask)
+            {
+                m_overflows.fetch_add(1, memory_order_relaxed);
+                return false;
+            }
+            m_values[tail & m_mask] = value;
+            m_tail.store(tail + 1, memory_order_release);
+            return true;
+        }
+        
+        //! Push a block of values.
+        /** The function pushes as many values of a block as the ring can store, it should only be called by the producer. The values that don't fit in the ring are dropped and counted as overflows.
+         @param size   The number of values.
+         @param values The values.
+         @return The number of values that have been pushed.
+         */
+        inline ulong push(const ulong size, const Type* values) noexcept
+        {
+            const ulong tail  = m_tail.load(memory_order_relaxed);
+            const ulong count = min(size, m_mask + 1 - (tail - m_head.load(memory_order_acquire)));
+            for(ulong i = 0; i < count; i++)
+            {
+                m_values[(tail + i) & m_mask] = values[i];
+            }
+            m_tail.store(tail + count, memory_order_release);
+            if(count < size)
+            {
+                m_overflows.fetch_add(size - count, memory_order_relaxed);
+            }
+            return count;
+        }
+        
+        //! Pop a value.
+        /** The function retrieves the oldest value of the ring, it should only be called by the consumer.
+         @param value The value.
+         @return True if a value has been retrieved.
+         */
+        inline bool pop(Type& value) noexcept
+        {
+            const ulong head = m_head.load(memory_order_relaxed);
+            if(head == m_tail.load(memory_order_acquire))
+            {
+                return false;
+            }
+            value = m_values[head & m_mask];
+            m_head.store(head + 1, memory_order_release);
+            return true;
+        }
+        
+        //! Retrieve the latest value.
+        /** The function retrieves the most recent value and discards the older ones, it should only be called by the consumer.
+         @param value The value.
+         @return True if a value has been retrieved, otherwise the value is unchanged.
+         */
+        inline bool getLatest(Type& value) noexcept
+        {
+            const ulong head = m_head.load(memory_order_relaxed);
+            const ulong tail = m_tail.load(memory_order_acquire);
+            if(head == tail)
+            {
+                return false;
+            }
+            value = m_values[(tail - 1) & m_mask];
+            m_head.store(tail, memory_order_release);
+            return true;
+        }
+        
+        //! Retrieve a decimated stream of values.
+        /** The function retrieves one value every decimation values in the order of the ring, it should only be called by the consumer. The decimation continues from one call to the next one and the function stops when the output is full or when the ring is empty.
+         @param size       The maximum number of values to retrieve.
+         @param values     The values.
+         @param decimation The decimation factor.
+         @return The number of values that have been retrieved.
+         */
+        inline ulong read(const ulong size, Type* values, const ulong decimation = 1) noexcept
+        {
+            const ulong tail    = m_tail.load(memory_order_acquire);
+            const ulong factor  = max(decimation, 1ul);
+            ulong head  = m_head.load(memory_order_relaxed);
+            ulong count = 0;
+            while(head != tail && count < size)
+            {
+                if(m_phase == 0)
+                {
+                    values[count++] = m_values[head & m_mask];
+                }
+                m_phase = (m_phase + 1) % factor;
+                head++;
+            }
+            m_head.store(head, memory_order_release);
+            return count;
+        }
+        
+        //! Retrieve the number of values in the ring.
+        /** The function retrieves the number of values that are waiting to be retrieved.
+         @return The number of values.
+         */
+        inline ulong getNumberOfValues() const noexcept
+        {
+            return m_tail.load(memory_order_acquire) - m_head.load(memory_order_acquire);
+        }
+        
+        //! Retrieve the number of overflows.
+        /** The function retrieves the number of values that have been dropped because the ring was full since the last clear.
+         @return The number of overflows.
+         */
+        inline ulong getNumberOfOverflows() const noexcept
+        {
+            return m_overflows.load(memory_order_relaxed);
+        }
+        
+        //! Clear the ring.
+        /** The function discards the values of the ring and resets the number of overflows and the decimation, it should only be called by the consumer.
+         */
+        inline void clear() noexcept
+        {
+            m_head.store(m_tail.load(memory_order_acquire), memory_order_release);
+            m_overflows.store(0, memory_order_relaxed);
+            m_phase = 0;
+        }
+    };
+}
+
+#endif
+
+
@@ -0,0 +1,405 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspFft.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      FFT SETUP                                   //
+    // ================================================================================ //
+    
+    FftSetup::FftSetup(const ulong size) :
+    m_size(size),
+    m_csize(size / 2)
+    {
+        const double pi = 3.14159265358979323846;
+        
+        // The radices, 4 first to reduce the number of passes, then the other factors.
+        ulong rest = m_csize;
+        while(!(rest % 4))
+        {
+            m_radices.push_back(4);
+            rest /= 4;
+        }
+        for(ulong factor = 2; rest > 1; factor++)
+        {
+            while(!(rest % factor))
+            {
+                m_radices.push_back(factor);
+                rest /= factor;
+            }
+        }
+        
+        // The twiddle factors of each pass and the roots of unity of the radices.
+        ulong n = m_csize, maxradix = 1;
+        for(vector<ulong>::size_type i = 0; i < m_radices.size(); i++)
+        {
+            const ulong radix = m_radices[i];
+            const ulong m = n / radix;
+            for(ulong j = 1; j < radix; j++)
+            {
+                for(ulong p = 0; p < m; p++)
+                {
+                    const double theta = -2. * pi * (double)(j * p) / (double)n;
+                    m_twiddles_real.push_back((sample)cos(theta));
+                    m_twiddles_imag.push_back((sample)sin(theta));
+                }
+            }
+            for(ulong j = 0; j < radix; j++)
+            {
+                const double theta = -2. * pi * (double)j / (double)radix;
+                m_roots_real.push_back((sample)cos(theta));
+                m_roots_imag.push_back((sample)sin(theta));
+            }
+            maxradix = max(maxradix, radix);
+            n = m;
+        }
+        
+        // The twiddle factors to split the half size complex transform in a real transform.
+        for(ulong k = 0; k <= m_csize; k++)
+        {
+            const double theta = -2. * pi * (double)k / (double)m_size;
+            m_post_real.push_back((sample)cos(theta));
+            m_post_imag.push_back((sample)sin(theta));
+        }
+        
+        m_work_real.resize(m_csize + 1);
+        m_work_imag.resize(m_csize + 1);
+        m_temp_real.resize(m_csize);
+        m_temp_imag.resize(m_csize);
+        m_butterfly.resize(maxradix * 2);
+
+#ifdef __APPLE__
+        m_log2 = 0;
+        if(Fft::isPowerOfTwo(m_size))
+        {
+            while((1ul << m_log2) < m_size)
+            {
+                m_log2++;
+            }
+#ifdef __KIWI_DSP_DOUBLE__
+            m_setup = vDSP_create_fftsetupD((vDSP_Length)m_log2, kFFTRadix2);
+#else
+            m_setup = vDSP_create_fftsetup((vDSP_Length)m_log2, kFFTRadix2);
+#endif
+        }
+        else
+        {
+            m_setup = nullptr;
+        }
+#endif
+    }
+    
+    FftSetup::~FftSetup()
+    {
+#ifdef __APPLE__
+        if(m_setup)
+        {
+#ifdef __KIWI_DSP_DOUBLE__
+            vDSP_destroy_fftsetupD(m_setup);
+#else
+            vDSP_destroy_fftsetup(m_setup);
+#endif
+        }
+#endif
+    }
+    
+    void FftSetup::transform(sample* real, sample* imag) const noexcept
+    {
+        sample* xr = real;
+        sample* xi = imag;
+        sample* yr = m_temp_real.data();
+        sample* yi = m_temp_imag.data();
+        const sample* twr = m_twiddles_real.data();
+        const sample* twi = m_twiddles_imag.data();
+        const sample* rtr = m_roots_real.data();
+        const sample* rti = m_roots_imag.data();
+        ulong n = m_csize, s = 1;
+        
+        for(vector<ulong>::size_type i = 0; i < m_radices.size(); i++)
+        {
+            const ulong radix = m_radices[i];
+            const ulong m = n / radix;
+            if(radix == 4)
+            {
+                for(ulong p = 0; p < m; p++)
+                {
+                    const sample w1r = twr[p], w1i = twi[p];
+                    const sample w2r = twr[m + p], w2i = twi[m + p];
+                    const sample w3r = twr[2 * m + p], w3i = twi[2 * m + p];
+                    const sample* ar0 = xr + s * p;
+                    const sample* ai0 = xi + s * p;
+                    const sample* ar1 = ar0 + s * m;
+                    const sample* ai1 = ai0 + s * m;
+                    const sample* ar2 = ar1 + s * m;
+                    const sample* ai2 = ai1 + s * m;
+                    const sample* ar3 = ar2 + s * m;
+                    const sample* ai3 = ai2 + s * m;
+                    sample* br0 = yr + s * 4 * p;
+                    sample* bi0 = yi + s * 4 * p;
+                    sample* br1 = br0 + s;
+                    sample* bi1 = bi0 + s;
+                    sample* br2 = br1 + s;
+                    sample* bi2 = bi1 + s;
+                    sample* br3 = br2 + s;
+                    sample* bi3 = bi2 + s;
+                    for(ulong q = 0; q < s; q++)
+                    {
+                        const sample t0r = ar0[q] + ar2[q], t0i = ai0[q] + ai2[q];
+                        const sample t1r = ar0[q] - ar2[q], t1i = ai0[q] - ai2[q];
+                        const sample t2r = ar1[q] + ar3[q], t2i = ai1[q] + ai3[q];
+                        const sample t3r = ar1[q] - ar3[q], t3i = ai1[q] - ai3[q];
+                        const sample c1r = t1r + t3i, c1i = t1i - t3r;
+                        const sample c2r = t0r - t2r, c2i = t0i - t2i;
+                        const sample c3r = t1r - t3i, c3i = t1i + t3r;
+                        br0[q] = t0r + t2r;
+                        bi0[q] = t0i + t2i;
+                        br1[q] = c1r * w1r - c1i * w1i;
+                        bi1[q] = c1r * w1i + c1i * w1r;
+                        br2[q] = c2r * w2r - c2i * w2i;
+                        bi2[q] = c2r * w2i + c2i * w2r;
+                        br3[q] = c3r * w3r - c3i * w3i;
+                        bi3[q] = c3r * w3i + c3i * w3r;
+                    }
+                }
+            }
+            else if(radix == 2)
+            {
+                for(ulong p = 0; p < m; p++)
+                {
+                    const sample wr = twr[p], wi = twi[p];
+                    const sample* ar0 = xr + s * p;
+                    const sample* ai0 = xi + s * p;
+                    const sample* ar1 = ar0 + s * m;
+                    const sample* ai1 = ai0 + s * m;
+                    sample* br0 = yr + s * 2 * p;
+                    sample* bi0 = yi + s * 2 * p;
+                    sample* br1 = br0 + s;
+                    sample* bi1 = bi0 + s;
+                    for(ulong q = 0; q < s; q++)
+                    {
+                        const sample cr = ar0[q] - ar1[q], ci = ai0[q] - ai1[q];
+                        br0[q] = ar0[q] + ar1[q];
+                        bi0[q] = ai0[q] + ai1[q];
+                        br1[q] = cr * wr - ci * wi;
+                        bi1[q] = cr * wi + ci * wr;
+                    }
+                }
+            }
+            else
+            {
+                sample* ar = m_butterfly.data();
+                sample* ai = ar + radix;
+                for(ulong p = 0; p < m; p++)
+                {
+                    for(ulong q = 0; q < s; q++)
+                    {
+                        for(ulong k = 0; k < radix; k++)
+                        {
+                            ar[k] = xr[q + s * (p + k * m)];
+                            ai[k] = xi[q + s * (p + k * m)];
+                        }
+                        for(ulong j = 0; j < radix; j++)
+                        {
+                            sample cr = 0, ci = 0;
+                            for(ulong k = 0, jk = 0; k < radix; k++, jk = (jk + j) % radix)
+                            {
+                                cr += ar[k] * rtr[jk] - ai[k] * rti[jk];
+                                ci += ar[k] * rti[jk] + ai[k] * rtr[jk];
+                            }
+                            if(j)
+                            {
+                                const sample wr = twr[(j - 1) * m + p], wi = twi[(j - 1) * m + p];
+                                yr[q + s * (radix * p + j)] = cr * wr - ci * wi;
+                                yi[q + s * (radix * p + j)] = cr * wi + ci * wr;
+                            }
+                            else
+                            {
+                                yr[q + s * radix * p] = cr;
+                                yi[q + s * radix * p] = ci;
+                            }
+                        }
+                    }
+                }
+            }
+            twr += (radix - 1) * m;
+            twi += (radix - 1) * m;
+            rtr += radix;
+            rti += radix;
+            swap(xr, yr);
+            swap(xi, yi);
+            s *= radix;
+            n  = m;
+        }
+        
+        if(xr != real)
+        {
+            Signal::vcopy(m_csize, xr, real);
+            Signal::vcopy(m_csize, xi, imag);
+        }
+    }
+    
+    // ================================================================================ //
+    //                                      FFT                                         //
+    // ================================================================================ //
+    
+    ulong Fft::getOptimalSize(const ulong size) noexcept
+    {
+        for(ulong candidate = max(size + (size & 1), 2ul);; candidate += 2)
+        {
+            ulong rest = candidate;
+            while(!(rest % 2))
+                rest /= 2;
+            while(!(rest % 3))
+                rest /= 3;
+            while(!(rest % 5))
+                rest /= 5;
+            if(rest == 1)
+            {
+                return candidate;
+            }
+        }
+    }
+    
+    sFftSetup Fft::create(const ulong size)
+    {
+        if(isValidSize(size))
+        {
+            return make_shared<FftSetup>(size);
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    void Fft::forward(FftSetup const& setup, const sample* in1, sample* real, sample* imag) noexcept
+    {
+        const ulong size = setup.m_csize;
+#ifdef __APPLE__
+        if(setup.m_setup)
+        {
+#ifdef __KIWI_DSP_DOUBLE__
+            DSPDoubleSplitComplex split = {real, imag};
+            vDSP_ctozD((const DSPDoubleComplex*)in1, 2, &split, 1, (vDSP_Length)size);
+            vDSP_fft_zripD(setup.m_setup, &split, 1, (vDSP_Length)setup.m_log2, kFFTDirection_Forward);
+#else
+            DSPSplitComplex split = {real, imag};
+            vDSP_ctoz((const DSPComplex*)in1, 2, &split, 1, (vDSP_Length)size);
+            vDSP_fft_zrip(setup.m_setup, &split, 1, (vDSP_Length)setup.m_log2, kFFTDirection_Forward);
+#endif
+            // vDSP packs the Nyquist bin in the first imaginary part and scales by 2.
+            real[size] = imag[0];
+            imag[0]    = 0;
+            imag[size] = 0;
+            Signal::vsmul(size + 1, (sample)0.5, real);
+            Signal::vsmul(size + 1, (sample)0.5, imag);
+            return;
+        }
+#endif
+        sample* zr = setup.m_work_real.data();
+        sample* zi = setup.m_work_imag.data();
+        for(ulong i = 0; i < size; i++)
+        {
+            zr[i] = in1[2 * i];
+            zi[i] = in1[2 * i + 1];
+        }
+        setup.transform(zr, zi);
+        zr[size] = zr[0];
+        zi[size] = zi[0];
+        
+        const sample* wr = setup.m_post_real.data();
+        const sample* wi = setup.m_post_imag.data();
+        for(ulong k = 0; k <= size / 2; k++)
+        {
+            const ulong l  = size - k;
+            const sample er = (sample)0.5 * (zr[k] + zr[l]);
+            const sample ei = (sample)0.5 * (zi[k] - zi[l]);
+            const sample or1 = (sample)0.5 * (zi[k] + zi[l]);
+            const sample oi = (sample)0.5 * (zr[l] - zr[k]);
+            const sample tr = wr[k] * or1 - wi[k] * oi;
+            const sample ti = wr[k] * oi + wi[k] * or1;
+            real[k] = er + tr;
+            imag[k] = ei + ti;
+            // The symmetric bin uses the conjugate of the same even and odd parts.
+            const sample sr = wr[l] * or1 + wi[l] * oi;
+            const sample si = wi[l] * or1 - wr[l] * oi;
+            real[l] = er + sr;
+            imag[l] = si - ei;
+        }
+        imag[0]    = 0;
+        imag[size] = 0;
+    }
+    
+    void Fft::inverse(FftSetup const& setup, const sample* real, const sample* imag, sample* out1) noexcept
+    {
+        const ulong size = setup.m_csize;
+        sample* zr = setup.m_work_real.data();
+        sample* zi = setup.m_work_imag.data();
+#ifdef __APPLE__
+        if(setup.m_setup)
+        {
+            Signal::vcopy(size, real, zr);
+            Signal::vcopy(size, imag, zi);
+            zi[0] = real[size];
+            const sample scale = (sample)1. / (sample)setup.m_size;
+#ifdef __KIWI_DSP_DOUBLE__
+            DSPDoubleSplitComplex split = {zr, zi};
+            vDSP_fft_zripD(setup.m_setup, &split, 1, (vDSP_Length)setup.m_log2, kFFTDirection_Inverse);
+            vDSP_ztocD(&split, 1, (DSPDoubleComplex*)out1, 2, (vDSP_Length)size);
+#else
+            DSPSplitComplex split = {zr, zi};
+            vDSP_fft_zrip(setup.m_setup, &split, 1, (vDSP_Length)setup.m_log2, kFFTDirection_Inverse);
+            vDSP_ztoc(&split, 1, (DSPComplex*)out1, 2, (vDSP_Length)size);
+#endif
+            Signal::vsmul(setup.m_size, scale, out1);
+            return;
+        }
+#endif
+        const sample* wr = setup.m_post_real.data();
+        const sample* wi = setup.m_post_imag.data();
+        // The even and odd parts are recombined with the imaginary and real parts swapped
+        // so the forward complex transform performs the inverse one.
+        for(ulong k = 0; k < size; k++)
+        {
+            const ulong l  = size - k;
+            const sample er = (sample)0.5 * (real[k] + real[l]);
+            const sample ei = (sample)0.5 * (imag[k] - imag[l]);
+            const sample dr = (sample)0.5 * (real[k] - real[l]);
+            const sample di = (sample)0.5 * (imag[k] + imag[l]);
+            const sample or1 = dr * wr[k] + di * wi[k];
+            const sample oi = di * wr[k] - dr * wi[k];
+            zi[k] = er - oi;
+            zr[k] = ei + or1;
+        }
+        setup.transform(zr, zi);
+        const sample scale = (sample)1. / (sample)size;
+        for(ulong i = 0; i < size; i++)
+        {
+            out1[2 * i]     = zi[i] * scale;
+            out1[2 * i + 1] = zr[i] * scale;
+        }
+    }
+}
+
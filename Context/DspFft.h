@@ -0,0 +1,177 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_FFT__
+#define __DEF_KIWI_DSP_FFT__
+
+#include "DspSignal.h"
+
+namespace Kiwi
+{
+    class FftSetup;
+    typedef shared_ptr<FftSetup>        sFftSetup;
+    typedef shared_ptr<const FftSetup>  scFftSetup;
+    
+    // ================================================================================ //
+    //                                      FFT SETUP                                   //
+    // ================================================================================ //
+    
+    //! The fft setup owns the precomputed informations of a real fast fourier transform.
+    /**
+     The fft setup owns the radices, the twiddle factors and the work space of a real transform of a given size. The creation allocates and computes the tables so it should never be done in the audio thread. A setup isn't reentrant, each node should use its own setup.
+     */
+    class FftSetup
+    {
+        friend class Fft;
+    private:
+        const ulong     m_size;
+        const ulong     m_csize;
+        vector<ulong>   m_radices;
+        vector<sample>  m_twiddles_real;
+        vector<sample>  m_twiddles_imag;
+        vector<sample>  m_roots_real;
+        vector<sample>  m_roots_imag;
+        vector<sample>  m_post_real;
+        vector<sample>  m_post_imag;
+        mutable vector<sample> m_work_real;
+        mutable vector<sample> m_work_imag;
+        mutable vector<sample> m_temp_real;
+        mutable vector<sample> m_temp_imag;
+        mutable vector<sample> m_butterfly;
+#ifdef __APPLE__
+        ulong           m_log2;
+#ifdef __KIWI_DSP_DOUBLE__
+        FFTSetupD       m_setup;
+#else
+        FFTSetup        m_setup;
+#endif
+#endif
+        
+        //! Perform the complex transform of the work space.
+        /** The function performs the forward complex transform of the work space with a Stockham autosort algorithm. The inverse transform is obtained by swapping the real and the imaginary parts.
+         @param real The real part of the work space.
+         @param imag The imaginary part of the work space.
+         */
+        void transform(sample* real, sample* imag) const noexcept;
+    
+    public:
+        
+        //! Constructor.
+        /** You should use the Fft::create method instead.
+         @param size The size of the real transform.
+         */
+        FftSetup(const ulong size);
+        
+        //! Destructor.
+        /** Free the tables.
+         */
+        ~FftSetup();
+        
+        //! Retrieve the size of the transform.
+        /** The function retrieves the number of real samples of the transform.
+         @return The size of the transform.
+         */
+        inline ulong getSize() const noexcept
+        {
+            return m_size;
+        }
+        
+        //! Retrieve the number of bins of the transform.
+        /** The function retrieves the number of complex bins of the spectrum, from the DC to the Nyquist frequency.
+         @return The number of bins of the transform.
+         */
+        inline ulong getNumberOfBins() const noexcept
+        {
+            return m_csize + 1;
+        }
+    };
+    
+    // ================================================================================ //
+    //                                      FFT                                         //
+    // ================================================================================ //
+    
+    //! The fft class offers static methods to perform real fast fourier transforms.
+    /**
+     The fft class offers static methods to perform real fast fourier transforms with split complex spectra. The sizes must be even, the transforms are mixed-radix (4, 2, 3, 5 and any other prime factor) and use the vDSP functions for the power of two sizes on Apple. The spectra have size / 2 + 1 bins, the imaginary parts of the DC and the Nyquist bins are always zero. The inverse transform is scaled so the inverse of the forward transform returns the original signal.
+     */
+    class Fft
+    {
+    public:
+        
+        //! Check if a size is valid.
+        /** The function checks if the size can be used to create a setup.
+         @param size The size of the transform.
+         @return true if the size is valid, otherwise false.
+         */
+        static inline bool isValidSize(const ulong size) noexcept
+        {
+            return size >= 2 && !(size & 1);
+        }
+        
+        //! Check if a size is a power of two.
+        /** The function checks if a size is a power of two.
+         @param size The size.
+         @return true if the size is a power of two, otherwise false.
+         */
+        static inline bool isPowerOfTwo(const ulong size) noexcept
+        {
+            return size && !(size & (size - 1));
+        }
+        
+        //! Retrieve the optimal size for a transform.
+        /** The function retrieves the smallest even size greater or equal to the size that only factors with 2, 3 and 5.
+         @param size The minimum size.
+         @return The optimal size.
+         */
+        static ulong getOptimalSize(const ulong size) noexcept;
+        
+        //! Create a setup.
+        /** The function allocates and computes a setup for a size. You should never call it in the audio thread.
+         @param size The size of the transform.
+         @return The setup or nullptr if the size isn't valid.
+         */
+        static sFftSetup create(const ulong size);
+        
+        //! Perform a forward transform.
+        /** The function performs a forward transform of a real signal.
+         @param setup The setup.
+         @param in1   The real signal with setup size samples.
+         @param real  The real part of the spectrum with setup size / 2 + 1 bins.
+         @param imag  The imaginary part of the spectrum with setup size / 2 + 1 bins.
+         */
+        static void forward(FftSetup const& setup, const sample* in1, sample* real, sample* imag) noexcept;
+        
+        //! Perform an inverse transform.
+        /** The function performs an inverse transform to a real signal.
+         @param setup The setup.
+         @param real  The real part of the spectrum with setup size / 2 + 1 bins.
+         @param imag  The imaginary part of the spectrum with setup size / 2 + 1 bins.
+         @param out1  The real signal with setup size samples.
+         */
+        static void inverse(FftSetup const& setup, const sample* real, const sample* imag, sample* out1) noexcept;
+    };
+}
+
+#endif
+
+
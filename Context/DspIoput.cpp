@@ -34,29 +34,70 @@ namespace Kiwi
     
     DspOutput::DspOutput(const ulong index) noexcept :
     m_index(index),
+    m_nchannels(1),
     m_vector(nullptr),
-    m_owner(false)
+    m_owner(false),
+    m_dvector(nullptr),
+    m_downer(false),
+    m_convert(false),
+    m_binding(nullptr)
     {
         
     }
     
+    DspOutput::DspOutput(DspOutput&& other) noexcept :
+    m_index(other.m_index),
+    m_nchannels(other.m_nchannels),
+    m_vector(other.m_vector),
+    m_owner(other.m_owner),
+    m_dvector(other.m_dvector),
+    m_downer(other.m_downer),
+    m_convert(other.m_convert),
+    m_binding(other.m_binding),
+    m_links(move(other.m_links))
+    {
+        other.m_vector  = nullptr;
+        other.m_owner   = false;
+        other.m_dvector = nullptr;
+        other.m_downer  = false;
+    }
+    
     DspOutput::~DspOutput()
     {
         if(m_owner && m_vector)
         {
             delete [] m_vector;
         }
+        if(m_downer && m_dvector)
+        {
+            delete [] m_dvector;
+        }
         m_links.clear();
     }
     
-    void DspOutput::add(sDspNode node)
+    void DspOutput::add(sDspNode node, const ulong index)
     {
-        m_links.insert(node);
+        for(DspPortList::size_type i = 0; i < m_links.size(); i++)
+        {
+            if(m_links[i].index == index && m_links[i].node.lock() == node)
+            {
+                return;
+            }
+        }
+        m_links.push_back({node, index});
     }
     
-    void DspOutput::remove(sDspNode node)
+    void DspOutput::remove(sDspNode node, const ulong index)
     {
-        m_links.erase(node);
+        for(DspPortList::size_type i = 0; i < m_links.size(); i++)
+        {
+            if(m_links[i].index == index && m_links[i].node.lock() == node)
+            {
+                m_links[i] = m_links.back();
+                m_links.pop_back();
+                return;
+            }
+        }
     }
     
     void DspOutput::clear()
@@ -67,7 +108,15 @@ namespace Kiwi
             delete [] m_vector;
             m_vector = nullptr;
         }
+        if(m_downer && m_dvector)
+        {
+            delete [] m_dvector;
+        }
+        m_dvector   = nullptr;
         m_owner     = false;
+        m_downer    = false;
+        m_convert   = false;
+        m_binding   = nullptr;
     }
     
     void DspOutput::start(sDspNode node) throw(DspError&)
@@ -75,32 +124,69 @@ namespace Kiwi
         if(m_owner && m_vector)
         {
             delete [] m_vector;
-            m_vector = nullptr;
         }
+        m_vector    = nullptr;
+        if(m_downer && m_dvector)
+        {
+            delete [] m_dvector;
+        }
+        m_dvector   = nullptr;
         m_owner     = false;
+        m_downer    = false;
+        m_convert   = false;
         
         if(node)
         {
-            if(node->isInplace() && node->getNumberOfInputs() > m_index)
+            const bool inplace = node->isInplace() && node->getNumberOfInputs() > m_index && node->m_inputs[m_index].getNumberOfChannels() == m_nchannels;
+            const bool bound   = m_binding && m_nchannels == 1 && !node->hasDoubleVectors();
+            if(node->hasDoubleVectors())
             {
-                m_vector = node->m_inputs[m_index]->getVector();
+                // The node writes in the double vector, the vector of sample only receives
+                // the conversion for the nodes in single precision so it can't be shared.
+                if(inplace)
+                {
+                    m_dvector = node->m_inputs[m_index].getDoubleVector();
+                    if(!m_dvector)
+                    {
+                        throw DspError(node, DspError::Inplace);
+                    }
+                }
+                else
+                {
+                    m_downer    = true;
+                    try
+                    {
+                        m_dvector   = new double[node->getVectorSize() * m_nchannels];
+                    }
+                    catch(bad_alloc& e)
+                    {
+                        throw DspError(node, DspError::Alloc);
+                    }
+                    Signal::vclear(node->getVectorSize() * m_nchannels, m_dvector);
+                }
+            }
+            else if(inplace)
+            {
+                m_vector = node->m_inputs[m_index].getVector();
                 if(!m_vector)
                 {
                     throw DspError(node, DspError::Inplace);
                 }
             }
-            if(!m_vector)
+            if(!m_vector && !bound)
             {
+                // A bound output doesn't have a vector, the inputs of the linked nodes
+                // retrieve the external vector at each cycle.
                 m_owner     = true;
                 try
                 {
-                    m_vector    = new sample[node->getVectorSize()];
+                    m_vector    = new sample[node->getVectorSize() * m_nchannels];
                 }
                 catch(bad_alloc& e)
                 {
                     throw DspError(node, DspError::Alloc);
                 }
-                Signal::vclear(node->getVectorSize(), m_vector);
+                Signal::vclear(node->getVectorSize() * m_nchannels, m_vector);
             }
         }
     }
@@ -111,36 +197,75 @@ namespace Kiwi
     
     DspInput::DspInput(const ulong index) noexcept :
     m_index(index),
+    m_size(0),
+    m_nchannels(1),
     m_vector(nullptr),
+    m_dvector(nullptr),
     m_nothers(0),
-    m_others(nullptr)
+    m_others(nullptr),
+    m_dothers(nullptr),
+    m_bindings(nullptr),
+    m_channels(nullptr)
     {
         
     }
     
+    DspInput::DspInput(DspInput&& other) noexcept :
+    m_index(other.m_index),
+    m_size(other.m_size),
+    m_nchannels(other.m_nchannels),
+    m_vector(other.m_vector),
+    m_dvector(other.m_dvector),
+    m_nothers(other.m_nothers),
+    m_others(other.m_others),
+    m_dothers(other.m_dothers),
+    m_bindings(other.m_bindings),
+    m_channels(other.m_channels),
+    m_links(move(other.m_links))
+    {
+        other.m_vector  = nullptr;
+        other.m_dvector = nullptr;
+        other.m_nothers = 0;
+    }
+    
     DspInput::~DspInput()
     {
-        if(m_nothers && m_others)
-        {
-            delete [] m_others;
-            m_others = nullptr;
-        }
         if(m_vector)
         {
             delete [] m_vector;
             m_vector = nullptr;
         }
+        if(m_dvector)
+        {
+            delete [] m_dvector;
+            m_dvector = nullptr;
+        }
         m_links.clear();
     }
     
-    void DspInput::add(sDspNode node)
+    void DspInput::add(sDspNode node, const ulong index)
     {
-        m_links.insert(node);
+        for(DspPortList::size_type i = 0; i < m_links.size(); i++)
+        {
+            if(m_links[i].index == index && m_links[i].node.lock() == node)
+            {
+                return;
+            }
+        }
+        m_links.push_back({node, index});
     }
     
-    void DspInput::remove(sDspNode node)
+    void DspInput::remove(sDspNode node, const ulong index)
     {
-        m_links.erase(node);
+        for(DspPortList::size_type i = 0; i < m_links.size(); i++)
+        {
+            if(m_links[i].index == index && m_links[i].node.lock() == node)
+            {
+                m_links[i] = m_links.back();
+                m_links.pop_back();
+                return;
+            }
+        }
     }
     
     void DspInput::clear()
@@ -151,11 +276,15 @@ namespace Kiwi
             delete [] m_vector;
             m_vector = nullptr;
         }
-        if(m_nothers && m_others)
+        if(m_dvector)
         {
-            delete [] m_others;
-            m_others = nullptr;
+            delete [] m_dvector;
+            m_dvector = nullptr;
         }
+        m_others    = nullptr;
+        m_dothers   = nullptr;
+        m_bindings  = nullptr;
+        m_channels  = nullptr;
         m_nothers   = 0;
     }
     
@@ -166,50 +295,40 @@ namespace Kiwi
             delete [] m_vector;
             m_vector = nullptr;
         }
-        if(m_nothers && m_others)
+        if(m_dvector)
         {
-            delete [] m_others;
-            m_others = nullptr;
+            delete [] m_dvector;
+            m_dvector = nullptr;
         }
+        m_others    = nullptr;
+        m_dothers   = nullptr;
+        m_bindings  = nullptr;
+        m_channels  = nullptr;
         m_nothers   = 0;
         
         if(node)
         {
             m_size = node->getVectorSize();
-            for(auto it = m_links.begin(); it != m_links.end(); )
+            for(DspPortList::size_type i = 0; i < m_links.size(); )
             {
-                sDspNode in = (*it).lock();
-                if(in)
+                if(m_links[i].node.expired())
                 {
-                    ++it;
+                    m_links[i] = m_links.back();
+                    m_links.pop_back();
                 }
                 else
                 {
-                    it = m_links.erase(it);
+                    i++;
                 }
             }
             m_nothers = m_links.size();
-            m_others  = new sample*[m_nothers];
-            ulong inc = 0;
-            for(auto it = m_links.begin(); it != m_links.end(); ++it)
+            for(DspPortList::size_type i = 0; i < m_links.size(); i++)
             {
-                sDspNode in = (*it).lock();
+                sDspNode in = m_links[i].node.lock();
                 if(in)
                 {
-                    sDspOutput output = nullptr;
-                    for(vector<DspNodeSet>::size_type i = 0; i < in->m_outputs.size(); i++)
-                    {
-                        if(in->m_outputs[i]->hasNode(node))
-                        {
-                            output = in->m_outputs[i];
-                            break;
-                        }
-                    }
-                    if(output)
-                    {
-                        m_others[inc++] = output->getVector();
-                    }
-                    else
+                    // The port must record an output of the linked node.
+                    if(m_links[i].index >= in->getNumberOfOutputs())
                     {
                         throw DspError(node, DspError::Recopy);
                     }
@@ -217,16 +336,57 @@ namespace Kiwi
             }
             try
             {
-                m_vector    = new sample[node->getVectorSize()];
+                if(node->hasDoubleVectors())
+                {
+                    m_dvector   = new double[node->getVectorSize() * m_nchannels];
+                    Signal::vclear(node->getVectorSize() * m_nchannels, m_dvector);
+                }
+                else
+                {
+                    m_vector    = new sample[node->getVectorSize() * m_nchannels];
+                    Signal::vclear(node->getVectorSize() * m_nchannels, m_vector);
+                }
             }
             catch(bad_alloc& e)
             {
                 throw DspError(node, DspError::Alloc);
             }
-            Signal::vclear(node->getVectorSize(), m_vector);
         }
     }
     
+    void DspInput::connect(DspNode const& node, sample** others, double** dothers, const sample* const** bindings, ulong* channels) noexcept
+    {
+        for(ulong i = 0; i < m_nothers; i++)
+        {
+            sDspNode in = m_links[i].node.lock();
+            DspOutput* output = in && m_links[i].index < in->getNumberOfOutputs() ? &in->m_outputs[m_links[i].index] : nullptr;
+            if(output)
+            {
+                // The double vector of the link is used if the node uses the double precision,
+                // otherwise the output converts its double vector to its vector of sample.
+                dothers[i]  = node.hasDoubleVectors() ? output->getDoubleVector() : nullptr;
+                if(!node.hasDoubleVectors() && output->getDoubleVector())
+                {
+                    output->m_convert = true;
+                }
+                channels[i] = output->getNumberOfChannels();
+                bindings[i] = output->getBinding();
+                others[i]   = output->getVector();
+            }
+            else
+            {
+                dothers[i]  = nullptr;
+                channels[i] = 1;
+                bindings[i] = nullptr;
+                others[i]   = nullptr;
+            }
+        }
+        m_others    = others;
+        m_dothers   = dothers;
+        m_bindings  = bindings;
+        m_channels  = channels;
+    }
+    
     // ================================================================================ //
     //                                      DSP LINK                                    //
     // ================================================================================ //
@@ -268,8 +428,8 @@ namespace Kiwi
         sDspNode  to    = getInputNode();
         if(chain && from && to && from != to)
         {
-            from->addOutput(to, getOutputIndex());
-            to->addInput(from, getInputIndex());
+            from->addOutput(to, getInputIndex(), getOutputIndex());
+            to->addInput(from, getOutputIndex(), getInputIndex());
         }
     }
 }
@@ -34,16 +34,22 @@ namespace Kiwi
     
     //! The ouput manages the sample vectors of one ouput of a node.
     /**
-     The ouput owns a vector of sample and manages the ownership and sharing of the vector between several dsp nodes.
+     The ouput owns a vector of sample and manages the ownership and sharing of the vector between several dsp nodes. An output carries one or several channels stored one after the other in the same vector. The output of a node that uses the double precision while the samples are in single precision also owns a vector of double, it is converted to the vector of sample only if a node in single precision is linked.
      */
     class DspOutput
     {
     private:
         friend DspChain;
+        friend DspInput;
         const ulong   m_index;
+        ulong         m_nchannels;
         sample*       m_vector;
         bool          m_owner;
-        DspNodeSet    m_links;
+        double*       m_dvector;
+        bool          m_downer;
+        bool          m_convert;
+        const sample* const* m_binding;
+        DspPortList   m_links;
         
     public:
         //! Constructor.
@@ -51,22 +57,32 @@ namespace Kiwi
          */
         DspOutput(const ulong index) noexcept;
         
+        //! Move constructor.
+        /** You should never have to call this method.
+         */
+        DspOutput(DspOutput&& other) noexcept;
+        
         //! Destructor.
         /** You should never have to call this method.
          */
         ~DspOutput();
         
+        DspOutput(DspOutput const& other) = delete;
+        DspOutput& operator=(DspOutput const& other) = delete;
+        
         //! Add a node to the output.
-        /** This function adds a node to the output.
-         @param The node to add.
+        /** This function adds an input of a node to the output.
+         @param node  The node to add.
+         @param index The index of the input of the node.
          */
-        void add(sDspNode node);
+        void add(sDspNode node, const ulong index);
         
         //! Remove a node from the output.
-        /** This function removes a node from the output.
-         @param The node to remove.
+        /** This function removes an input of a node from the output.
+         @param node  The node to remove.
+         @param index The index of the input of the node.
          */
-        void remove(sDspNode node);
+        void remove(sDspNode node, const ulong index);
         
         //! Remove all the nodes from the output.
         /** This function removes all the nodes from the output.
@@ -103,7 +119,14 @@ namespace Kiwi
          */
         inline bool hasNode(sDspNode node) const
         {
-            return m_links.find(node) != m_links.end();
+            for(DspPortList::size_type i = 0; i < m_links.size(); i++)
+            {
+                if(m_links[i].node.lock() == node)
+                {
+                    return true;
+                }
+            }
+            return false;
         }
         
         //! Check if the output is the owner of the vector.
@@ -115,14 +138,71 @@ namespace Kiwi
             return m_owner;
         }
         
+        //! Retrieve the number of channels of the output.
+        /** This function retrieves the number of channels of the output.
+         @return The number of channels.
+         */
+        inline ulong getNumberOfChannels() const noexcept
+        {
+            return m_nchannels;
+        }
+        
+        //! Set the number of channels of the output.
+        /** This function sets the number of channels of the output. The change is effective when the output is prepared.
+         @param nchannels The number of channels.
+         */
+        inline void setNumberOfChannels(const ulong nchannels) noexcept
+        {
+            m_nchannels = max(nchannels, 1ul);
+        }
+        
+        //! Bind the output to an external vector.
+        /** This function sets the address of a pointer to a vector that the output uses instead of allocating its own vector, like a buffer of the device. The pointer is read by the inputs of the linked nodes at each cycle so the vector can change from one cycle to the next, it isn't owned by the output and the linked nodes only read it. The binding is only used if the output has one channel and the node doesn't use the double precision, and it is removed when the output is cleared.
+         @param binding The address of the pointer to the vector or nullptr.
+         */
+        inline void setBinding(const sample* const* binding) noexcept
+        {
+            m_binding = binding;
+        }
+        
+        //! Retrieve the binding of the output.
+        /** This function retrieves the address of the pointer to the external vector if the output is bound and hasn't its own vector.
+         @return The binding of the output or nullptr.
+         */
+        inline const sample* const* getBinding() const noexcept
+        {
+            return m_vector ? nullptr : m_binding;
+        }
+        
         //! Retrieve the vector of the output.
-        /** This function retrieves the vector of the output.
+        /** This function retrieves the vector of the output, the channels are stored one after the other.
          @return The vector of the output.
          */
         inline sample* getVector() const noexcept
         {
             return m_vector;
         }
+        
+        //! Retrieve the double vector of the output.
+        /** This function retrieves the double vector of the output if the node uses the double precision while the samples are in single precision.
+         @return The double vector of the output or nullptr.
+         */
+        inline double* getDoubleVector() const noexcept
+        {
+            return m_dvector;
+        }
+        
+        //! Convert the double vector of the output.
+        /** This function converts the double vector to the vector of sample if a node in single precision is linked to the output.
+         @param size The vector size.
+         */
+        inline void convert(const ulong size) noexcept
+        {
+            if(m_convert)
+            {
+                Signal::vcopy(size * m_nchannels, m_dvector, m_vector);
+            }
+        }
     };
     
     // ================================================================================ //
@@ -131,7 +211,7 @@ namespace Kiwi
     
     //! The input manages the sample vectors of one input of a node.
     /**
-     The input owns a vector of sample and manages the ownership and sharing of the vector between several dsp nodes.
+     The input owns a vector of sample and manages the ownership and sharing of the vector between several dsp nodes. An input carries one or several channels stored one after the other in the same vector. A mono output linked to an input with several channels is sent to all the channels, otherwise the channels are linked one by one and the missing ones are silent. The vectors of the links are stored in arrays shared by all the inputs of the chain so they are read sequentially during a cycle.
      */
     class DspInput
     {
@@ -139,10 +219,88 @@ namespace Kiwi
         friend DspChain;
         const ulong   m_index;
         ulong         m_size;
+        ulong         m_nchannels;
         sample*       m_vector;
+        double*       m_dvector;
         ulong         m_nothers;
-        sample**      m_others;
-        DspNodeSet    m_links;
+        sample* const*  m_others;
+        double* const*  m_dothers;
+        const sample* const* const* m_bindings;
+        const ulong*  m_channels;
+        DspPortList   m_links;
+        
+        //! Perform the copy or the addition of a link.
+        /** This function copies or adds the channels of the vector of a link to a vector, the samples are converted if the precisions differ.
+         @param other     The vector of the link.
+         @param nchannels The number of channels of the link.
+         @param vector    The vector of the input.
+         @param add       True to add, false to copy.
+         */
+        template<class T, class U> inline void perform(const T* other, const ulong nchannels, U* vector, const bool add) noexcept
+        {
+            if(nchannels == m_nchannels)
+            {
+                if(add)
+                {
+                    Signal::vadd(m_size * m_nchannels, other, vector);
+                }
+                else
+                {
+                    Signal::vcopy(m_size * m_nchannels, other, vector);
+                }
+                return;
+            }
+            for(ulong i = 0; i < m_nchannels; i++)
+            {
+                if(nchannels == 1 || i < nchannels)
+                {
+                    const T* in1 = nchannels == 1 ? other : other + i * m_size;
+                    if(add)
+                    {
+                        Signal::vadd(m_size, in1, vector + i * m_size);
+                    }
+                    else
+                    {
+                        Signal::vcopy(m_size, in1, vector + i * m_size);
+                    }
+                }
+                else if(!add)
+                {
+                    Signal::vclear(m_size, vector + i * m_size);
+                }
+            }
+        }
+        
+        //! Perform the copy of the links to a vector.
+        /** This function copies the links to a vector, the double vectors of the links are used when they're available and the vectors of the bound outputs are retrieved for the cycle.
+         @param vector The vector of the input.
+         */
+        template<class T> inline void perform(T* vector) noexcept
+        {
+            for(ulong i = 0; i < m_nothers; i++)
+            {
+                if(m_dothers[i])
+                {
+                    perform(m_dothers[i], m_channels[i], vector, i != 0);
+                }
+                else if(m_others[i])
+                {
+                    perform(m_others[i], m_channels[i], vector, i != 0);
+                }
+                else
+                {
+                    const sample* other = m_bindings[i] ? *m_bindings[i] : nullptr;
+                    if(other)
+                    {
+                        perform(other, m_channels[i], vector, i != 0);
+                    }
+                    else if(i == 0)
+                    {
+                        Signal::vclear(m_size * m_nchannels, vector);
+                    }
+                }
+            }
+        }
     public:
         
         //! Constructor.
@@ -150,22 +308,32 @@ namespace Kiwi
          */
         DspInput(const ulong index) noexcept;
         
+        //! Move constructor.
+        /** You should never have to call this method.
+         */
+        DspInput(DspInput&& other) noexcept;
+        
         //! Destructor.
         /** You should never have to call this method.
          */
         ~DspInput();
         
+        DspInput(DspInput const& other) = delete;
+        DspInput& operator=(DspInput const& other) = delete;
+        
         //! Add a node to the input.
-        /** This function adds  a node to the input.
-         @param The node to add.
+        /** This function adds an output of a node to the input.
+         @param node  The node to add.
+         @param index The index of the output of the node.
          */
-        void add(sDspNode node);
+        void add(sDspNode node, const ulong index);
         
         //! Remove a node from the input.
-        /** This function removes  a node from the input.
-         @param The node to remove.
+        /** This function removes an output of a node from the input.
+         @param node  The node to remove.
+         @param index The index of the output of the node.
          */
-        void remove(sDspNode node);
+        void remove(sDspNode node, const ulong index);
         
         //! Remove all the nodes from the input.
         /** This function removes all the nodes from the input.
@@ -173,10 +341,29 @@ namespace Kiwi
         void clear();
         
         //! Prepare the input.
-        /** This function prepare the input.
+        /** This function prepare the input. The vectors of the links are retrieved when the input is connected.
          */
         void start(sDspNode node) throw(DspError&);
         
+        //! Connect the input to the vectors of the links.
+        /** This function writes the vectors of the links of the input in the arrays of the chain, from the first position of the input, and keeps the arrays to read them at each cycle. The input should be prepared and the outputs of the linked nodes too.
+         @param node     The owner node.
+         @param others   The vectors of sample of the links.
+         @param dothers  The double vectors of the links.
+         @param bindings The bindings of the links.
+         @param channels The numbers of channels of the links.
+         */
+        void connect(DspNode const& node, sample** others, double** dothers, const sample* const** bindings, ulong* channels) noexcept;
+        
+        //! Retrieve the number of vectors of the links.
+        /** This function retrieves the number of vectors the input reads at each cycle, it is defined when the input is prepared.
+         @return The number of vectors.
+         */
+        inline ulong getNumberOfVectors() const noexcept
+        {
+            return m_nothers;
+        }
+        
         //! Retrieve if the links are empty.
         /** This function retrieves if the links are empty.
          @param true if if the links are empty, otherwise false.
@@ -195,8 +382,26 @@ namespace Kiwi
             return (ulong)m_links.size();
         }
         
+        //! Retrieve the number of channels of the input.
+        /** This function retrieves the number of channels of the input.
+         @return The number of channels.
+         */
+        inline ulong getNumberOfChannels() const noexcept
+        {
+            return m_nchannels;
+        }
+        
+        //! Set the number of channels of the input.
+        /** This function sets the number of channels of the input. The change is effective when the input is prepared.
+         @param nchannels The number of channels.
+         */
+        inline void setNumberOfChannels(const ulong nchannels) noexcept
+        {
+            m_nchannels = max(nchannels, 1ul);
+        }
+        
         //! Retrieve the vector of the input.
-        /** This function retrieves the vector of the input.
+        /** This function retrieves the vector of the input, the channels are stored one after the other.
          @return The vector of the input.
          */
         inline sample* getVector() const noexcept
@@ -204,18 +409,27 @@ namespace Kiwi
             return m_vector;
         }
         
+        //! Retrieve the double vector of the input.
+        /** This function retrieves the double vector of the input if the node uses the double precision while the samples are in single precision.
+         @return The double vector of the input or nullptr.
+         */
+        inline double* getDoubleVector() const noexcept
+        {
+            return m_dvector;
+        }
+        
         //! Perform the copy of the links to input vector.
-        /** This function perform sthe copy of the links to input vector.
+        /** This function perform sthe copy of the links to input vector. The links with the same number of channels and the same precision are copied with one operation.
          */
         inline void perform() noexcept
         {
-            if(m_nothers)
+            if(m_dvector)
             {
-                Signal::vcopy(m_size, m_others[0], m_vector);
+                perform(m_dvector);
             }
-            for(ulong i = 1; i < m_nothers; i++)
+            else
             {
-                Signal::vadd(m_size, m_others[i], m_vector);
+                perform(m_vector);
             }
         }
     };
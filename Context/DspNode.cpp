@@ -34,28 +34,35 @@ namespace Kiwi
     DspNode::DspNode(sDspChain chain, const ulong nins, const ulong nouts) noexcept :
     m_chain(chain),
     m_nins(nins),
-    m_sample_ins(new sample*[m_nins]),
+    m_sample_ins(new sample*[nins + nouts]),
+    m_double_ins(new double*[nins + nouts]),
     m_nouts(nouts),
-    m_sample_outs(new sample*[m_nouts]),
+    m_sample_outs(m_sample_ins + nins),
+    m_double_outs(m_double_ins + nins),
     m_samplerate(0),
     m_vectorsize(0),
     m_inplace(true),
-    m_running(false)
+    m_running(false),
+    m_double(false)
     {
+        // The ports are stored by value and the tables of the inputs and the outputs
+        // share the same arrays.
+        m_inputs.reserve(getNumberOfInputs());
         for(ulong i = 0; i < getNumberOfInputs(); i++)
         {
-            m_inputs.push_back(make_shared<DspInput>(i));
+            m_inputs.emplace_back(i);
         }
+        m_outputs.reserve(getNumberOfOutputs());
         for(ulong i = 0; i < getNumberOfOutputs(); i++)
         {
-            m_outputs.push_back(make_shared<DspOutput>(i));
+            m_outputs.emplace_back(i);
         }
     }
     
     DspNode::~DspNode()
     {
         delete [] m_sample_ins;
-        delete [] m_sample_outs;
+        delete [] m_double_ins;
         m_inputs.clear();
         m_outputs.clear();
     }
@@ -86,46 +93,80 @@ namespace Kiwi
         }
     }
     
-    void DspNode::addInput(sDspNode node, const ulong index)
+    void DspNode::addInput(sDspNode node, const ulong output, const ulong index)
     {
         if(index < (ulong)m_inputs.size())
         {
-            m_inputs[index]->add(node);
+            m_inputs[index].add(node, output);
         }
     }
     
-    void DspNode::addOutput(sDspNode node, const ulong index)
+    void DspNode::addOutput(sDspNode node, const ulong input, const ulong index)
     {
         if(index < (ulong)m_outputs.size())
         {
-            m_outputs[index]->add(node);
+            m_outputs[index].add(node, input);
         }
     }
     
-    void DspNode::removeInput(sDspNode node, const ulong index)
+    void DspNode::removeInput(sDspNode node, const ulong output, const ulong index)
     {
-        if(index < (ulong)m_outputs.size())
+        if(index < (ulong)m_inputs.size())
         {
-            m_inputs[index]->remove(node);
+            m_inputs[index].remove(node, output);
         }
     }
     
-    void DspNode::removeOutput(sDspNode node, const ulong index)
+    void DspNode::removeOutput(sDspNode node, const ulong input, const ulong index)
     {
         if(index < (ulong)m_outputs.size())
         {
-            m_outputs[index]->remove(node);
+            m_outputs[index].remove(node, input);
         }
     }
     
     bool DspNode::isInputConnected(const ulong index) const noexcept
     {
-        return !m_inputs[index]->empty();
+        return !m_inputs[index].empty();
     }
     
     bool DspNode::isOutputConnected(const ulong index) const noexcept
     {
-        return !m_outputs[index]->empty();
+        return !m_outputs[index].empty();
+    }
+    
+    ulong DspNode::getNumberOfInputChannels(const ulong index) const noexcept
+    {
+        return index < m_nins ? m_inputs[index].getNumberOfChannels() : 0;
+    }
+    
+    ulong DspNode::getNumberOfOutputChannels(const ulong index) const noexcept
+    {
+        return index < m_nouts ? m_outputs[index].getNumberOfChannels() : 0;
+    }
+    
+    void DspNode::setNumberOfInputChannels(const ulong index, const ulong nchannels) noexcept
+    {
+        if(index < m_nins)
+        {
+            m_inputs[index].setNumberOfChannels(nchannels);
+        }
+    }
+    
+    void DspNode::setNumberOfOutputChannels(const ulong index, const ulong nchannels) noexcept
+    {
+        if(index < m_nouts)
+        {
+            m_outputs[index].setNumberOfChannels(nchannels);
+        }
+    }
+    
+    void DspNode::setOutputBinding(const ulong index, const sample* const* binding) noexcept
+    {
+        if(index < m_nouts)
+        {
+            m_outputs[index].setBinding(binding);
+        }
     }
     
     void DspNode::setInplace(const bool status) noexcept
@@ -133,6 +174,24 @@ namespace Kiwi
         m_inplace = status;
     }
     
+    void DspNode::setDoublePrecision(const bool status) noexcept
+    {
+        m_double = status;
+    }
+    
+    void DspNode::post(DspParameter& parameter, const sample value, const ulong time) noexcept
+    {
+        sDspChain chain = getChain();
+        if(chain)
+        {
+            chain->post(this, &parameter, value, time);
+        }
+        else
+        {
+            parameter.setValue(value);
+        }
+    }
+    
     void DspNode::shouldPerform(const bool status) noexcept
     {
         m_running = status;
@@ -148,40 +207,106 @@ namespace Kiwi
                 stop();
             }
 
+            setup();
+            
+            try
+            {
+                allocate();
+            }
+            catch(DspError& e)
+            {
+                throw e;
+            }
+        }
+    }
+    
+    void DspNode::setup() noexcept
+    {
+        sDspChain chain = getChain();
+        if(chain)
+        {
             m_samplerate = chain->getSampleRate();
             m_vectorsize = chain->getVectorSize();
-            
             prepare();
+        }
+    }
+    
+    void DspNode::restart() throw(DspError&)
+    {
+        sDspChain chain = getChain();
+        if(chain)
+        {
+            m_samplerate = chain->getSampleRate();
+            m_vectorsize = chain->getVectorSize();
             
-            if(m_running)
+            resize();
+            
+            try
             {
-                for(ulong i = 0; i < getNumberOfInputs(); i++)
+                allocate();
+            }
+            catch(DspError& e)
+            {
+                throw e;
+            }
+        }
+    }
+    
+    void DspNode::resize() noexcept
+    {
+        release();
+        prepare();
+    }
+    
+    void DspNode::allocate() throw(DspError&)
+    {
+        if(m_running)
+        {
+            for(ulong i = 0; i < getNumberOfInputs(); i++)
+            {
+                try
                 {
-                    try
-                    {
-                        m_inputs[i]->start(shared_from_this());
-                    }
-                    catch(DspError& e)
-                    {
-                        m_running = false;
-                        throw e;
-                    }
-                    m_sample_ins[i] = m_inputs[i]->getVector();
+                    m_inputs[i].start(shared_from_this());
                 }
-                for(ulong i = 0; i < getNumberOfOutputs(); i++)
+                catch(DspError& e)
                 {
-                    try
-                    {
-                        m_outputs[i]->start(shared_from_this());
-                    }
-                    catch(DspError& e)
-                    {
-                        m_running = false;
-                        throw e;
-                    }
-                    
-                    m_sample_outs[i] = m_outputs[i]->getVector();
+                    m_running = false;
+                    throw e;
                 }
+                m_sample_ins[i] = m_inputs[i].getVector();
+                m_double_ins[i] = m_inputs[i].getDoubleVector();
+            }
+            for(ulong i = 0; i < getNumberOfOutputs(); i++)
+            {
+                try
+                {
+                    m_outputs[i].start(shared_from_this());
+                }
+                catch(DspError& e)
+                {
+                    m_running = false;
+                    throw e;
+                }
+                
+                m_sample_outs[i] = m_outputs[i].getVector();
+                m_double_outs[i] = m_outputs[i].getDoubleVector();
+            }
+        }
+        else
+        {
+            // If the node doesn't perform anymore after a resize, its signals are freed
+            // so the linked nodes don't read the vectors of the previous size.
+            for(ulong i = 0; i < getNumberOfInputs(); i++)
+            {
+                m_inputs[i].start(nullptr);
+                m_sample_ins[i] = nullptr;
+                m_double_ins[i] = nullptr;
+            }
+            for(ulong i = 0; i < getNumberOfOutputs(); i++)
+            {
+                m_outputs[i].start(nullptr);
+                m_sample_outs[i] = nullptr;
+                m_double_outs[i] = nullptr;
             }
         }
     }
@@ -192,11 +317,11 @@ namespace Kiwi
         release();
         for(ulong i = 0; i < getNumberOfInputs(); i++)
         {
-            m_inputs[i]->clear();
+            m_inputs[i].clear();
         }
         for(ulong i = 0; i < getNumberOfOutputs(); i++)
         {
-            m_outputs[i]->clear();
+            m_outputs[i].clear();
         }
     }
 }
@@ -25,6 +25,8 @@
 #define __DEF_KIWI_DSP_NODE__
 
 #include "DspIoput.h"
+#include "DspParameter.h"
+#include "DspFeedback.h"
 
 namespace Kiwi
 {
@@ -47,15 +49,18 @@ namespace Kiwi
         const wDspChain m_chain;
         const ulong     m_nins;
         sample** const  m_sample_ins;
+        double** const  m_double_ins;
         const ulong     m_nouts;
         sample** const  m_sample_outs;
+        double** const  m_double_outs;
         ulong           m_samplerate;
         ulong           m_vectorsize;
-        vector<sDspInput>  m_inputs;
-        vector<sDspOutput> m_outputs;
+        vector<DspInput>   m_inputs;
+        vector<DspOutput>  m_outputs;
         
         bool            m_inplace;
         bool            m_running;
+        bool            m_double;
         ulong           index;
         
         //! Prepare the node to process.
@@ -64,6 +69,21 @@ namespace Kiwi
          */
         void start() throw(DspError&);
         
+        //! Prepare the node for the chain.
+        /** This function updates the sample rate and the vector size of the node with the ones of the chain and calls the prepare method, the signals aren't allocated.
+         */
+        void setup() noexcept;
+        
+        //! Allocate the signals of the node.
+        /** This function allocates the signals for the inputs and the outputs if the node should perform.
+         */
+        void allocate() throw(DspError&);
+        
+        //! Resize the node for the chain.
+        /** This function updates the sample rate and the vector size of the node with the ones of the chain, calls the resize method and allocates the signals again, the links are kept.
+         */
+        void restart() throw(DspError&);
+        
         //! Call once the process method of the inputs and of the process class.
         /** This function calls once the process.
          */
@@ -71,9 +91,25 @@ namespace Kiwi
         {
             for(ulong i = 0; i < m_nins; i++)
             {
-                m_inputs[i]->perform();
+                m_inputs[i].perform();
             }
             perform();
+            if(hasDoubleVectors())
+            {
+                for(ulong i = 0; i < m_nouts; i++)
+                {
+                    m_outputs[i].convert(m_vectorsize);
+                }
+            }
+        }
+        
+        //! Check if the node owns double vectors.
+        /** This function checks if the node uses the double precision while the samples are in single precision, in this case the inputs and the outputs of the node own double vectors.
+         @return True if the node owns double vectors.
+         */
+        inline bool hasDoubleVectors() const noexcept
+        {
+            return m_double && sizeof(sample) != sizeof(double);
         }
         
         //! Notify the process that the dsp has been stopped.
@@ -82,32 +118,36 @@ namespace Kiwi
         void stop();
         
         //! Add a node to an input.
-        /** This function adds a node to an input.
-         @param node The node to add.
-         @param index The index of the input.
+        /** This function adds an output of a node to an input.
+         @param node   The node to add.
+         @param output The index of the output of the node.
+         @param index  The index of the input.
          */
-        void addInput(sDspNode node, const ulong index);
+        void addInput(sDspNode node, const ulong output, const ulong index);
         
         //! Add a node to an output.
-        /** This function adds a node to an output.
-         @param node The node to add.
+        /** This function adds an input of a node to an output.
+         @param node  The node to add.
+         @param input The index of the input of the node.
          @param index The index of the output.
          */
-        void addOutput(sDspNode node, const ulong index);
+        void addOutput(sDspNode node, const ulong input, const ulong index);
         
         //! Remove a node from an input.
-        /** This function removes a node from an input.
-         @param node The node to remove.
-         @param index The index of the input.
+        /** This function removes an output of a node from an input.
+         @param node   The node to remove.
+         @param output The index of the output of the node.
+         @param index  The index of the input.
          */
-        void removeInput(sDspNode node, const ulong index);
+        void removeInput(sDspNode node, const ulong output, const ulong index);
         
         //! Remove a node from an output.
-        /** This function removes a node from an output.
-         @param node The node to remove.
+        /** This function removes an input of a node from an output.
+         @param node  The node to remove.
+         @param input The index of the input of the node.
          @param index The index of the output.
          */
-        void removeOutput(sDspNode node, const ulong index);
+        void removeOutput(sDspNode node, const ulong input, const ulong index);
         
         //! Prepare the process for the dsp.
         /** The method preprares the dsp.
@@ -127,6 +167,20 @@ namespace Kiwi
          */
         virtual void release() noexcept = 0;
         
+        //! Resize the process for the dsp.
+        /** The method is called instead of the prepare method when the sample rate or the vector size of the chain changes while the dsp is running, the node can adapt its buffers and keep its state. By default, the method releases and prepares the node again.
+         */
+        virtual void resize() noexcept;
+        
+        //! Retrieve the nodes that should be performed before the node.
+        /** The method retrieves the nodes of the chain that aren't linked to the node but that should be performed before it, for example because they share a buffer. If one of these nodes depends on the node, the order is ignored and the pair breaks the loop. By default, the method retrieves nothing.
+         @param nodes The vector of nodes to fill.
+         */
+        virtual void getPredecessors(vector<sDspNode>&) const noexcept
+        {
+            ;
+        }
+        
     public:
         
         //! The constructor.
@@ -217,6 +271,68 @@ namespace Kiwi
             return m_sample_outs;
         }
         
+        //! Retrieve the inputs double matrix.
+        /** This function retrieves the inputs double matrix of a node that uses the double precision. If the samples are in double precision, it's the inputs sample matrix.
+         @return The inputs double matrix.
+         */
+        inline double *const * getInputsDoubles() const noexcept
+        {
+#ifdef __KIWI_DSP_DOUBLE__
+            return m_sample_ins;
+#else
+            return m_double_ins;
+#endif
+        }
+        
+        //! Retrieve the outputs double matrix.
+        /** This function retrieves the outputs double matrix of a node that uses the double precision. If the samples are in double precision, it's the outputs sample matrix.
+         @return The outputs double matrix.
+         */
+        inline double** getOutputsDoubles() const noexcept
+        {
+#ifdef __KIWI_DSP_DOUBLE__
+            return m_sample_outs;
+#else
+            return m_double_outs;
+#endif
+        }
+        
+        //! Retrieve the number of channels of an input.
+        /** This function retrieves the number of channels of an input.
+         @param index The index of the input.
+         @return The number of channels of the input.
+         */
+        ulong getNumberOfInputChannels(const ulong index) const noexcept;
+        
+        //! Retrieve the number of channels of an output.
+        /** This function retrieves the number of channels of an output.
+         @param index The index of the output.
+         @return The number of channels of the output.
+         */
+        ulong getNumberOfOutputChannels(const ulong index) const noexcept;
+        
+        //! Retrieve the vector of a channel of an input.
+        /** This function retrieves the vector of a channel of an input, the channels of an input are stored one after the other.
+         @param index   The index of the input.
+         @param channel The index of the channel.
+         @return The vector of the channel.
+         */
+        inline sample* getInputSamples(const ulong index, const ulong channel) const noexcept
+        {
+            return m_sample_ins[index] + channel * m_vectorsize;
+        }
+        
+        //! Retrieve the vector of a channel of an output.
+        /** This function retrieves the vector of a channel of an output, the channels of an output are stored one after the other.
+         @param index   The index of the output.
+         @param channel The index of the channel.
+         @return The vector of the channel.
+         */
+        inline sample* getOutputSamples(const ulong index, const ulong channel) const noexcept
+        {
+            return m_sample_outs[index] + channel * m_vectorsize;
+        }
+        
         //! Check if the inputs and outputs signals owns the same vectors.
         /** This function checks if the signals owns the same vectors.
          @return True if the signals owns the same vectors it returns false.
@@ -235,14 +351,32 @@ namespace Kiwi
             return m_running;
         }
         
+        //! Check if the node uses the double precision.
+        /** This function checks if the node processes its signals in double precision. The nodes in double precision and in single precision can be linked, the signals are only converted between them.
+         @return True if the node uses the double precision otherwise it returns false.
+         */
+        inline bool isDoublePrecision() const noexcept
+        {
+            return m_double || sizeof(sample) == sizeof(double);
+        }
+        
+        //! Retrieve the index of the node in the dsp chain.
+        /** This function retrieves the position of the node in the order of the dsp chain. The index is defined when the chain is compiled, it starts at 1 and 0 means that the node isn't sorted.
+         @return The index of the node.
+         */
+        inline ulong getIndex() const noexcept
+        {
+            return index;
+        }
+        
         //! Check if a signal inlet is connected with signal.
-        /** This function checks if a signal inlet is connected with signal.
+        /** This function checks if a signal inlet is connected with signal. It should be called when the node is prepared, the links can change while the node performs.
          @return True if the inlet is connected otherwise it returns false.
          */
         bool isInputConnected(const ulong index) const noexcept;
         
         //! Check if a signal outlet is connected with signal.
-        /** This function checks if a signal outlet is connected with signal.
+        /** This function checks if a signal outlet is connected with signal. It should be called when the node is prepared, the links can change while the node performs.
          @return True if the outlet is connected otherwise it returns false.
          */
         bool isOutputConnected(const ulong index) const noexcept;
@@ -261,6 +395,41 @@ namespace Kiwi
          */
         void setInplace(const bool status) noexcept;
         
+        //! Set if the node uses the double precision.
+        /** This function sets if the node processes its signals in double precision while the samples are in single precision. The node should then use the double matrices instead of the sample matrices. It should be called in the constructor or when the node is prepared.
+         @param status The precision status.
+         */
+        void setDoublePrecision(const bool status) noexcept;
+        
+        //! Post a change of a parameter of the node.
+        /** This function posts a change of a parameter to the dsp chain that applies it at a time of the chain. If the node doesn't have a chain, the value is set immediately.
+         @param parameter The parameter.
+         @param value     The new value.
+         @param time      The time in samples of the chain, 0 to apply the change at the beginning of the next vector.
+         */
+        void post(DspParameter& parameter, const sample value, const ulong time = 0) noexcept;
+        
+        //! Set the number of channels of an input.
+        /** This function sets the number of channels of an input. It should be called in the constructor or when the node is prepared.
+         @param index     The index of the input.
+         @param nchannels The number of channels.
+         */
+        void setNumberOfInputChannels(const ulong index, const ulong nchannels) noexcept;
+        
+        //! Set the number of channels of an output.
+        /** This function sets the number of channels of an output. It should be called in the constructor or when the node is prepared.
+         @param index     The index of the output.
+         @param nchannels The number of channels.
+         */
+        void setNumberOfOutputChannels(const ulong index, const ulong nchannels) noexcept;
+        
+        //! Bind an output to an external vector.
+        /** This function sets the address of a pointer to a vector that an output uses instead of allocating its own vector, like a buffer of the device, the output should have one channel. The pointer is read at each cycle so the vector can change from one cycle to the next. It should be called when the node is prepared, the nodes linked to the output only read the vector.
+         @param index   The index of the output.
+         @param binding The address of the pointer to the vector or nullptr.
+         */
+        void setOutputBinding(const ulong index, const sample* const* binding) noexcept;
+        
         //! Set if the node should be call in the dsp chain.
         /** This function sets if the node should be call in the dsp chain.
          @param status The perform status.
@@ -0,0 +1,162 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspParameter.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      DSP PARAMETER                               //
+    // ================================================================================ //
+    
+    DspParameter::DspParameter(const sample value, const Smoothing smoothing, const double time) noexcept :
+    m_smoothing(smoothing),
+    m_time(max(time, 0.)),
+    m_length(0),
+    m_coefficient(0.),
+    m_value(value),
+    m_target(value),
+    m_step(0.),
+    m_count(0),
+    m_nevents(0),
+    m_cursor(0),
+    m_position(0)
+    {
+        ;
+    }
+    
+    DspParameter::~DspParameter()
+    {
+        ;
+    }
+    
+    void DspParameter::setSmoothing(const Smoothing smoothing, const double time) noexcept
+    {
+        m_smoothing = smoothing;
+        m_time      = max(time, 0.);
+    }
+    
+    void DspParameter::prepare(const ulong samplerate) noexcept
+    {
+        const double length = m_time * double(samplerate);
+        if(m_smoothing == Exponential && length >= 1.)
+        {
+            // The exponential smoothing is stopped after seven time constants,
+            // when the remaining distance is under a thousandth of a percent.
+            m_coefficient = sample(exp(-1. / length));
+            m_length      = ulong(length * 7.);
+        }
+        else if(m_smoothing == Linear)
+        {
+            m_length      = ulong(length);
+        }
+        else
+        {
+            m_length      = 0;
+        }
+        m_value     = m_target;
+        m_count     = 0;
+        m_nevents   = 0;
+        m_cursor    = 0;
+        m_position  = 0;
+    }
+    
+    void DspParameter::setValue(const sample value) noexcept
+    {
+        m_value     = value;
+        m_target    = value;
+        m_count     = 0;
+        m_nevents   = 0;
+        m_cursor    = 0;
+        m_position  = 0;
+    }
+    
+    void DspParameter::target(const sample value) noexcept
+    {
+        m_target = value;
+        if(m_length > 1 && m_smoothing != None)
+        {
+            m_count = m_length;
+            m_step  = (m_target - m_value) / sample(m_length);
+        }
+        else
+        {
+            m_value = m_target;
+            m_count = 0;
+        }
+    }
+    
+    void DspParameter::schedule(const sample value, const ulong offset) noexcept
+    {
+        if(m_nevents < c_nevents)
+        {
+            m_events[m_nevents++] = {offset, value};
+        }
+        else
+        {
+            m_events[c_nevents - 1] = {offset, value};
+        }
+    }
+    
+    void DspParameter::perform(const ulong size, sample* out1) noexcept
+    {
+        ulong index = 0;
+        for(ulong i = 0; i < size; i++)
+        {
+            while(index < m_nevents && m_events[index].offset <= i)
+            {
+                target(m_events[index++].value);
+            }
+            out1[i] = m_value;
+            tick();
+        }
+        m_nevents   = 0;
+        m_cursor    = 0;
+        m_position  = 0;
+    }
+    
+    bool DspParameter::next(const ulong size, ulong& start, ulong& end, sample& value) noexcept
+    {
+        if(m_position >= size)
+        {
+            m_nevents   = 0;
+            m_cursor    = 0;
+            m_position  = 0;
+            return false;
+        }
+        while(m_cursor < m_nevents && m_events[m_cursor].offset <= m_position)
+        {
+            target(m_events[m_cursor++].value);
+        }
+        start   = m_position;
+        end     = m_cursor < m_nevents ? min(m_events[m_cursor].offset, size) : size;
+        value   = m_value;
+        for(ulong i = start; i < end && m_count; i++)
+        {
+            tick();
+        }
+        m_position = end;
+        return true;
+    }
+}
+
@@ -0,0 +1,175 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_PARAMETER__
+#define __DEF_KIWI_DSP_PARAMETER__
+
+#include "DspSignal.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      DSP PARAMETER                               //
+    // ================================================================================ //
+    
+    //! The dsp parameter is a value of a node that changes at precise positions of the vectors.
+    /**
+     The dsp parameter is owned by a node and only modified by the audio thread. The changes are posted to the dsp chain with a time in samples, the chain dispatches them at the beginning of the vector where they occur and the parameter applies them at their offset in the vector. The value can jump to the new values or reach them with a linear or an exponential smoothing. The node can retrieve the values sample by sample, or the segments of the vector where the value is constant, or use the current value directly when the parameter doesn't change during the vector.
+     */
+    class DspParameter
+    {
+    public:
+        
+        //! The smoothings of the parameter.
+        enum Smoothing
+        {
+            None        = 0, ///< The value jumps to the new values.
+            Linear      = 1, ///< The value reaches the new values linearly in the smoothing time.
+            Exponential = 2  ///< The value reaches the new values exponentially with the smoothing time as time constant.
+        };
+    
+    private:
+        static const ulong c_nevents = 32;
+        
+        struct Event
+        {
+            ulong   offset;
+            sample  value;
+        };
+        
+        Smoothing   m_smoothing;
+        double      m_time;
+        ulong       m_length;
+        sample      m_coefficient;
+        sample      m_value;
+        sample      m_target;
+        sample      m_step;
+        ulong       m_count;
+        Event       m_events[c_nevents];
+        ulong       m_nevents;
+        ulong       m_cursor;
+        ulong       m_position;
+        
+        //! Move the value toward the target.
+        /** The function moves the value of one sample toward the target.
+         */
+        inline void tick() noexcept
+        {
+            if(m_count)
+            {
+                if(--m_count)
+                {
+                    m_value = (m_smoothing == Linear) ? m_value + m_step : m_target + (m_value - m_target) * m_coefficient;
+                }
+                else
+                {
+                    m_value = m_target;
+                }
+            }
+        }
+        
+        //! Start to move the value toward a new target.
+        /** The function sets the target and the smoothing toward it.
+         @param value The target.
+         */
+        void target(const sample value) noexcept;
+    
+    public:
+        
+        //! Constructor.
+        /** The function initializes the parameter.
+         @param value     The initial value.
+         @param smoothing The smoothing.
+         @param time      The smoothing time in seconds.
+         */
+        DspParameter(const sample value = 0., const Smoothing smoothing = None, const double time = 0.) noexcept;
+        
+        //! Destructor.
+        ~DspParameter();
+        
+        //! Set the smoothing.
+        /** The function sets the smoothing and its time. It should be called before the node is prepared.
+         @param smoothing The smoothing.
+         @param time      The smoothing time in seconds.
+         */
+        void setSmoothing(const Smoothing smoothing, const double time) noexcept;
+        
+        //! Prepare the parameter.
+        /** The function computes the smoothing for a sample rate. It should be called when the node is prepared.
+         @param samplerate The sample rate.
+         */
+        void prepare(const ulong samplerate) noexcept;
+        
+        //! Set the value immediately.
+        /** The function sets the value without smoothing and removes the pending changes. It should only be called when the node doesn't perform.
+         @param value The value.
+         */
+        void setValue(const sample value) noexcept;
+        
+        //! Schedule a change in the current vector.
+        /** The function is called by the dsp chain at the beginning of a vector for the changes that occur during the vector. The changes should be scheduled in the order of their offsets, if too many changes are scheduled in a vector, the last change is replaced.
+         @param value  The new value.
+         @param offset The offset of the change in the vector.
+         */
+        void schedule(const sample value, const ulong offset) noexcept;
+        
+        //! Retrieve the current value.
+        /** The function retrieves the value at the current position of the vector.
+         @return The value.
+         */
+        inline sample getValue() const noexcept
+        {
+            return m_value;
+        }
+        
+        //! Check if the value is constant during the vector.
+        /** The function checks if no change occurs and no smoothing is in progress during the vector, in this case the node can use the current value for the whole vector and doesn't have to call the perform or the next methods.
+         @return True if the value is constant.
+         */
+        inline bool isConstant() const noexcept
+        {
+            return !m_nevents && !m_count;
+        }
+        
+        //! Perform the values of a vector.
+        /** The function writes the values of each sample of the vector and applies the changes at their offsets.
+         @param size The vector size.
+         @param out1 The vector of values.
+         */
+        void perform(const ulong size, sample* out1) noexcept;
+        
+        //! Retrieve the next segment of the vector where the value is constant.
+        /** The function retrieves the next part of the vector that ends at the next change. If the parameter is smoothed, the value of the segment is the value at its beginning. The function returns false and the parameter is ready for the next vector when the end of the vector is reached.
+         @param size  The vector size.
+         @param start The beginning of the segment.
+         @param end   The end of the segment.
+         @param value The value of the segment.
+         @return True if a segment has been retrieved.
+         */
+        bool next(const ulong size, ulong& start, ulong& end, sample& value) noexcept;
+    };
+}
+
+#endif
+
+
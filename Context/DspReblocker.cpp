@@ -0,0 +1,115 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspReblocker.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      DSP REBLOCKER                               //
+    // ================================================================================ //
+    
+    DspReblocker::DspReblocker() noexcept :
+    m_ninputs(0),
+    m_noutputs(0),
+    m_blocksize(0),
+    m_hostsize(0),
+    m_size(0),
+    m_mask(0),
+    m_input_head(0),
+    m_input_tail(0),
+    m_output_head(0),
+    m_output_tail(0),
+    m_latency(0)
+    {
+        ;
+    }
+    
+    DspReblocker::~DspReblocker()
+    {
+        ;
+    }
+    
+    void DspReblocker::prepare(const ulong ninputs, const ulong noutputs, const ulong blocksize, const ulong hostsize)
+    {
+        m_ninputs   = ninputs;
+        m_noutputs  = noutputs;
+        m_blocksize = max(blocksize, 1ul);
+        m_hostsize  = max(hostsize, 1ul);
+        
+        // The input ring holds the samples of the host and a partial block, the output
+        // ring holds the samples of the host, the latency and a block.
+        m_size = 1;
+        while(m_size < m_hostsize + 2 * m_blocksize)
+        {
+            m_size <<= 1;
+        }
+        m_mask = m_size - 1;
+        m_inputs.assign(m_ninputs * m_size, 0.);
+        m_outputs.assign(m_noutputs * m_size, 0.);
+        m_block_inputs.assign(m_ninputs * m_blocksize, 0.);
+        m_block_outputs.assign(m_noutputs * m_blocksize, 0.);
+        
+        // The host never waits for a block if the output ring starts with the largest
+        // part of a block that can remain in the input ring after a buffer of the host.
+        ulong a = m_hostsize, b = m_blocksize;
+        while(b)
+        {
+            const ulong r = a % b;
+            a = b;
+            b = r;
+        }
+        const ulong latency = (m_hostsize % m_blocksize) ? m_blocksize - a : 0;
+        m_input_head    = 0;
+        m_input_tail    = 0;
+        m_output_head   = 0;
+        m_output_tail   = latency;
+        m_latency       = latency;
+    }
+    
+    bool DspReblocker::pull() noexcept
+    {
+        const ulong head = m_input_head.load(memory_order_relaxed);
+        if(m_input_tail.load(memory_order_acquire) - head < m_blocksize)
+        {
+            return false;
+        }
+        for(ulong i = 0; i < m_ninputs; i++)
+        {
+            copy(m_blocksize, m_inputs.data() + i * m_size, head, m_block_inputs.data() + i * m_blocksize);
+        }
+        m_input_head.store(head + m_blocksize, memory_order_release);
+        return true;
+    }
+    
+    void DspReblocker::push() noexcept
+    {
+        const ulong tail = m_output_tail.load(memory_order_relaxed);
+        for(ulong i = 0; i < m_noutputs; i++)
+        {
+            copy(m_blocksize, m_block_outputs.data() + i * m_blocksize, m_outputs.data() + i * m_size, tail);
+        }
+        m_output_tail.store(tail + m_blocksize, memory_order_release);
+    }
+}
+
@@ -0,0 +1,232 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_REBLOCKER__
+#define __DEF_KIWI_DSP_REBLOCKER__
+
+#include "DspSignal.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      DSP REBLOCKER                               //
+    // ================================================================================ //
+    
+    //! The dsp reblocker adapts the buffers of the host to the blocks of the engine.
+    /**
+     The dsp reblocker lets the engine perform blocks of a fixed size whatever the number of samples the host gives at each callback. The samples of the host are pushed in an input ring, the engine performs a block each time the input ring has enough samples and pushes the result in an output ring where the host retrieves its samples. The rings are lock-free with one producer and one consumer so the blocks could also be performed by another thread. When the size of the buffers of the host isn't a multiple of the block size, the output ring starts with silence so the host never waits for a block, this latency is the smallest one for the size of the host and it grows if the host changes the size of its buffers.
+     */
+    class DspReblocker
+    {
+    private:
+        ulong           m_ninputs;
+        ulong           m_noutputs;
+        ulong           m_blocksize;
+        ulong           m_hostsize;
+        ulong           m_size;
+        ulong           m_mask;
+        vector<sample>  m_inputs;
+        vector<sample>  m_outputs;
+        vector<sample>  m_block_inputs;
+        vector<sample>  m_block_outputs;
+        atomic_ulong    m_input_head;
+        atomic_ulong    m_input_tail;
+        atomic_ulong    m_output_head;
+        atomic_ulong    m_output_tail;
+        atomic_ulong    m_latency;
+        
+        //! Copy samples in a ring.
+        /** The function copies samples at a position of a ring, the samples are cleared if the input is null.
+         */
+        template <class Type> inline void copy(const ulong size, const Type* in1, sample* ring, const ulong position) const noexcept
+        {
+            const ulong start = position & m_mask;
+            const ulong first = min(size, m_size - start);
+            if(in1)
+            {
+                Signal::vcopy(first, in1, ring + start);
+                Signal::vcopy(size - first, in1 + first, ring);
+            }
+            else
+            {
+                Signal::vclear(first, ring + start);
+                Signal::vclear(size - first, ring);
+            }
+        }
+        
+        //! Copy samples from a ring.
+        /** The function copies samples from a position of a ring.
+         */
+        template <class Type> inline void copy(const ulong size, const sample* ring, const ulong position, Type* out1) const noexcept
+        {
+            const ulong start = position & m_mask;
+            const ulong first = min(size, m_size - start);
+            Signal::vcopy(first, ring + start, out1);
+            Signal::vcopy(size - first, ring, out1 + first);
+        }
+        
+        //! Push the samples of the host in the input ring.
+        template <class Type> inline void write(const ulong size, const ulong offset, const ulong ninputs, const Type* const* inputs) noexcept
+        {
+            const ulong tail = m_input_tail.load(memory_order_relaxed);
+            for(ulong i = 0; i < m_ninputs; i++)
+            {
+                copy(size, (i < ninputs && inputs[i]) ? inputs[i] + offset : (const Type*)nullptr, m_inputs.data() + i * m_size, tail);
+            }
+            m_input_tail.store(tail + size, memory_order_release);
+        }
+        
+        //! Retrieve the samples of the host from the output ring.
+        template <class Type> inline void read(const ulong size, const ulong offset, const ulong noutputs, Type* const* outputs) noexcept
+        {
+            // If the ring doesn't have enough samples, the host receives silence and
+            // the next samples are delayed.
+            const ulong head    = m_output_head.load(memory_order_relaxed);
+            const ulong count   = min(size, m_output_tail.load(memory_order_acquire) - head);
+            for(ulong i = 0; i < noutputs && i < m_noutputs; i++)
+            {
+                if(outputs[i])
+                {
+                    copy(count, m_outputs.data() + i * m_size, head, outputs[i] + offset);
+                    Signal::vclear(size - count, outputs[i] + offset + count);
+                }
+            }
+            m_output_head.store(head + count, memory_order_release);
+            if(count < size)
+            {
+                m_latency.fetch_add(size - count, memory_order_relaxed);
+            }
+        }
+        
+        //! Retrieve a block from the input ring.
+        /** The function copies the samples of a block in the input buffers of the block.
+         @return True if the input ring had enough samples.
+         */
+        bool pull() noexcept;
+        
+        //! Push a block in the output ring.
+        /** The function copies the output buffers of the block in the output ring.
+         */
+        void push() noexcept;
+    
+    public:
+        
+        //! Constructor.
+        /** The function initializes an empty reblocker.
+         */
+        DspReblocker() noexcept;
+        
+        //! Destructor.
+        ~DspReblocker();
+        
+        //! Prepare the reblocker.
+        /** The function allocates the rings and the buffers of the block, computes the latency and fills the output ring with the silence of the latency. It should be called when the host doesn't perform.
+         @param ninputs   The number of input channels.
+         @param noutputs  The number of output channels.
+         @param blocksize The size of the blocks of the engine.
+         @param hostsize  The size of the buffers of the host.
+         */
+        void prepare(const ulong ninputs, const ulong noutputs, const ulong blocksize, const ulong hostsize);
+        
+        //! Retrieve the block size.
+        /** The function retrieves the size of the blocks of the engine.
+         @return The block size.
+         */
+        inline ulong getBlockSize() const noexcept
+        {
+            return m_blocksize;
+        }
+        
+        //! Retrieve the latency.
+        /** The function retrieves the number of samples that the outputs are delayed by the reblocking.
+         @return The latency in samples.
+         */
+        inline ulong getLatency() const noexcept
+        {
+            return m_latency.load(memory_order_relaxed);
+        }
+        
+        //! Retrieve the number of input channels.
+        inline ulong getNumberOfInputs() const noexcept
+        {
+            return m_ninputs;
+        }
+        
+        //! Retrieve the number of output channels.
+        inline ulong getNumberOfOutputs() const noexcept
+        {
+            return m_noutputs;
+        }
+        
+        //! Retrieve the input buffer of a channel of the block.
+        /** The function retrieves the samples of a channel that the engine reads during a block.
+         @param channel The index of the channel.
+         @return The samples or nullptr.
+         */
+        inline sample* getInputs(const ulong channel) noexcept
+        {
+            return channel < m_ninputs ? m_block_inputs.data() + channel * m_blocksize : nullptr;
+        }
+        
+        //! Retrieve the output buffer of a channel of the block.
+        /** The function retrieves the samples of a channel that the engine writes during a block.
+         @param channel The index of the channel.
+         @return The samples or nullptr.
+         */
+        inline sample* getOutputs(const ulong channel) noexcept
+        {
+            return channel < m_noutputs ? m_block_outputs.data() + channel * m_blocksize : nullptr;
+        }
+        
+        //! Process the buffers of the host.
+        /** The function pushes the samples of the host in the input ring, performs all the blocks that are ready with the function and retrieves the samples of the host from the output ring. The buffers of the host can have any size, the missing or null input channels are silent and the null output channels are ignored.
+         @param size     The number of samples of the buffers of the host.
+         @param ninputs  The number of input channels of the host.
+         @param inputs   The input channels of the host.
+         @param noutputs The number of output channels of the host.
+         @param outputs  The output channels of the host.
+         @param perform  The function that performs a block.
+         */
+        template <class Type, class Function> void process(const ulong size, const ulong ninputs, const Type* const* inputs, const ulong noutputs, Type* const* outputs, Function perform) noexcept
+        {
+            // The buffers are processed in parts of the size of the host for which
+            // the rings have been allocated.
+            for(ulong offset = 0; offset < size && m_hostsize;)
+            {
+                const ulong count = min(size - offset, m_hostsize);
+                write(count, offset, ninputs, inputs);
+                while(pull())
+                {
+                    perform();
+                    push();
+                }
+                read(count, offset, noutputs, outputs);
+                offset += count;
+            }
+        }
+    };
+}
+
+#endif
+
+
@@ -25,6 +25,11 @@
 #define __DEF_KIWI_DSP_SIGNAL__
 
 #include "../Core/Core.h"
+#include <unordered_map>
+#include <unordered_set>
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#endif
 
 namespace Kiwi
 {
@@ -70,13 +75,61 @@ namespace Kiwi
     typedef shared_ptr<const DspDeviceManager>  scDspDeviceManager;
     typedef weak_ptr<const DspDeviceManager>    wcDspDeviceManager;
     
-    typedef set<weak_ptr<DspNode>, owner_less< weak_ptr<DspNode>>> DspNodeSet;
+    //! The port of a linked node.
+    struct DspPort
+    {
+        wDspNode    node;   ///< The linked node.
+        ulong       index;  ///< The index of the output or of the input of the linked node.
+    };
+    typedef vector<DspPort> DspPortList;
     
     enum DspMode : bool
     {
         DspScalar = false,
         DspVector = true
     };
+    
+    //! Add an element to an indexed vector.
+    /** The function adds an element at the end of a vector if the map of the positions of the elements doesn't contain it yet, in constant time.
+     @param elements The vector of elements.
+     @param indices  The positions of the elements in the vector.
+     @param element  The element to add.
+     @return True if the element has been added.
+     */
+    template <class Type> inline bool insertIndexed(vector<shared_ptr<Type>>& elements, unordered_map<const Type*, ulong>& indices, shared_ptr<Type> const& element)
+    {
+        if(indices.insert({element.get(), (ulong)elements.size()}).second)
+        {
+            elements.push_back(element);
+            return true;
+        }
+        return false;
+    }
+    
+    //! Remove an element from an indexed vector.
+    /** The function removes an element from a vector in constant time, the last element of the vector takes its place.
+     @param elements The vector of elements.
+     @param indices  The positions of the elements in the vector.
+     @param element  The element to remove.
+     @return True if the element has been removed.
+     */
+    template <class Type> inline bool eraseIndexed(vector<shared_ptr<Type>>& elements, unordered_map<const Type*, ulong>& indices, shared_ptr<Type> const& element)
+    {
+        auto it = indices.find(element.get());
+        if(it != indices.end())
+        {
+            const ulong index = it->second;
+            indices.erase(it);
+            if(index + 1 != (ulong)elements.size())
+            {
+                elements[index] = elements.back();
+                indices[elements[index].get()] = index;
+            }
+            elements.pop_back();
+            return true;
+        }
+        return false;
+    }
 }
 
 namespace Kiwi
@@ -125,6 +178,26 @@ namespace Kiwi
 #endif
         }
         
+        static inline void vcopy(const ulong vectorsize, const float* in1, double* out1)
+        {
+#ifdef __APPLE__
+            vDSP_vspdp(in1, 1, out1, 1, (vDSP_Length)vectorsize);
+#else
+            for(ulong i = 0; i < vectorsize; i++)
+                out1[i] = (double)in1[i];
+#endif
+        }
+        
+        static inline void vcopy(const ulong vectorsize, const double* in1, float* out1)
+        {
+#ifdef __APPLE__
+            vDSP_vdpsp(in1, 1, out1, 1, (vDSP_Length)vectorsize);
+#else
+            for(ulong i = 0; i < vectorsize; i++)
+                out1[i] = (float)in1[i];
+#endif
+        }
+        
         static inline void vinterleave(const ulong vectorsize, const ulong nrow, const float* in1, float* out1)
         {
 #if defined (__APPLE__) || defined(__CBLAS__)
@@ -137,7 +210,7 @@ namespace Kiwi
             {
                 for(ulong j = 0; j < vectorsize; j++)
                 {
-                    *(out1++) = *(in1+nrow+j*nrow);
+                    out1[j * nrow + i] = in1[i * vectorsize + j];
                 }
             }
 #endif
@@ -155,7 +228,25 @@ namespace Kiwi
             {
                 for(ulong j = 0; j < vectorsize; j++)
                 {
-                    *(out1++) = *(in1+nrow+j*nrow);
+                    out1[j * nrow + i] = in1[i * vectorsize + j];
+                }
+            }
+#endif
+        }
+        
+        static inline void vinterleave(const ulong vectorsize, const ulong nrow, const double* in1, float* out1)
+        {
+#ifdef __APPLE__
+            for(ulong i = 0; i < nrow; i++)
+            {
+                vDSP_vdpsp(in1+i*vectorsize, 1, out1+i, (vDSP_Stride)nrow, (vDSP_Length)vectorsize);
+            }
+#else
+            for(ulong i = 0; i < nrow; i++)
+            {
+                for(ulong j = 0; j < vectorsize; j++)
+                {
+                    out1[j * nrow + i] = (float)in1[i * vectorsize + j];
                 }
             }
 #endif
@@ -173,7 +264,7 @@ namespace Kiwi
             {
                 for(ulong j = 0; j < vectorsize; j++)
                 {
-                    *(out1++) = *(in1+nrow+j*nrow);
+                    out1[i * vectorsize + j] = in1[j * nrow + i];
                 }
             }
 #endif
@@ -191,7 +282,25 @@ namespace Kiwi
             {
                 for(ulong j = 0; j < vectorsize; j++)
                 {
-                    *(out1++) = *(in1+nrow+j*nrow);
+                    out1[i * vectorsize + j] = in1[j * nrow + i];
+                }
+            }
+#endif
+        }
+        
+        static inline void vdeterleave(const ulong vectorsize, const ulong nrow, const float* in1, double* out1)
+        {
+#ifdef __APPLE__
+            for(ulong i = 0; i < nrow; i++)
+            {
+                vDSP_vspdp(in1+i, (vDSP_Stride)nrow, out1+i*vectorsize, 1, (vDSP_Length)vectorsize);
+            }
+#else
+            for(ulong i = 0; i < nrow; i++)
+            {
+                for(ulong j = 0; j < vectorsize; j++)
+                {
+                    out1[i * vectorsize + j] = (double)in1[j * nrow + i];
                 }
             }
 #endif
@@ -280,6 +389,18 @@ namespace Kiwi
 #endif
         }
         
+        static inline void vadd(ulong vectorsize, const float* in1, double* out1)
+        {
+            while(vectorsize--)
+                *(out1++) += (double)*(in1++);
+        }
+        
+        static inline void vadd(ulong vectorsize, const double* in1, float* out1)
+        {
+            while(vectorsize--)
+                *(out1++) += (float)*(in1++);
+        }
+        
         static inline void vadd(ulong vectorsize, const float* in1, const float* in2, float* out1)
         {
 #ifdef __APPLE__
@@ -306,6 +427,228 @@ namespace Kiwi
 #endif
         }
         
+        static inline void vsmul(ulong vectorsize, const float& in1, float* out1)
+        {
+#ifdef __APPLE__
+            vDSP_vsmul(out1, 1, &in1, out1, 1, vectorsize);
+#elif __CBLAS__
+            cblas_sscal((const int)vectorsize, in1, out1, 1);
+#else
+            while(vectorsize--)
+                *(out1++) *= in1;
+#endif
+        }
+        
+        static inline void vsmul(ulong vectorsize, const double& in1, double* out1)
+        {
+#ifdef __APPLE__
+            vDSP_vsmulD(out1, 1, &in1, out1, 1, vectorsize);
+#elif __CBLAS__
+            cblas_dscal((const int)vectorsize, in1, out1, 1);
+#else
+            while(vectorsize--)
+                *(out1++) *= in1;
+#endif
+        }
+        
+        static inline void vmul(ulong vectorsize, const float* in1, float* out1)
+        {
+#ifdef __APPLE__
+            vDSP_vmul(in1, 1, out1, 1, out1, 1, (vDSP_Length)vectorsize);
+#else
+            while(vectorsize--)
+                *(out1++) *= *(in1++);
+#endif
+        }
+        
+        static inline void vmul(ulong vectorsize, const double* in1, double* out1)
+        {
+#ifdef __APPLE__
+            vDSP_vmulD(in1, 1, out1, 1, out1, 1, (vDSP_Length)vectorsize);
+#else
+            while(vectorsize--)
+                *(out1++) *= *(in1++);
+#endif
+        }
+        
+        static inline float vdot(ulong vectorsize, const float* in1, const float* in2)
+        {
+#if defined (__APPLE__) || defined(__CBLAS__)
+            return cblas_sdot((const int)vectorsize, in1, 1, in2, 1);
+#else
+            float sum0 = 0., sum1 = 0., sum2 = 0., sum3 = 0.;
+            for(; vectorsize >= 4; vectorsize -= 4, in1 += 4, in2 += 4)
+            {
+                sum0 += in1[0] * in2[0];
+                sum1 += in1[1] * in2[1];
+                sum2 += in1[2] * in2[2];
+                sum3 += in1[3] * in2[3];
+            }
+            while(vectorsize--)
+                sum0 += *(in1++) * *(in2++);
+            return (sum0 + sum1) + (sum2 + sum3);
+#endif
+        }
+        
+        static inline double vdot(ulong vectorsize, const double* in1, const double* in2)
+        {
+#if defined (__APPLE__) || defined(__CBLAS__)
+            return cblas_ddot((const int)vectorsize, in1, 1, in2, 1);
+#else
+            double sum0 = 0., sum1 = 0., sum2 = 0., sum3 = 0.;
+            for(; vectorsize >= 4; vectorsize -= 4, in1 += 4, in2 += 4)
+            {
+                sum0 += in1[0] * in2[0];
+                sum1 += in1[1] * in2[1];
+                sum2 += in1[2] * in2[2];
+                sum3 += in1[3] * in2[3];
+            }
+            while(vectorsize--)
+                sum0 += *(in1++) * *(in2++);
+            return (sum0 + sum1) + (sum2 + sum3);
+#endif
+        }
+        
+        static inline void vcmuladd(ulong vectorsize, const float* real1, const float* imag1, const float* real2, const float* imag2, float* real3, float* imag3)
+        {
+#ifdef __APPLE__
+            DSPSplitComplex in1 = {const_cast<float*>(real1), const_cast<float*>(imag1)};
+            DSPSplitComplex in2 = {const_cast<float*>(real2), const_cast<float*>(imag2)};
+            DSPSplitComplex out1 = {real3, imag3};
+            vDSP_zvma(&in1, 1, &in2, 1, &out1, 1, &out1, 1, (vDSP_Length)vectorsize);
+#else
+            for(ulong i = 0; i < vectorsize; i++)
+            {
+                real3[i] += real1[i] * real2[i] - imag1[i] * imag2[i];
+                imag3[i] += real1[i] * imag2[i] + imag1[i] * real2[i];
+            }
+#endif
+        }
+        
+        static inline void vcmuladd(ulong vectorsize, const double* real1, const double* imag1, const double* real2, const double* imag2, double* real3, double* imag3)
+        {
+#ifdef __APPLE__
+            DSPDoubleSplitComplex in1 = {const_cast<double*>(real1), const_cast<double*>(imag1)};
+            DSPDoubleSplitComplex in2 = {const_cast<double*>(real2), const_cast<double*>(imag2)};
+            DSPDoubleSplitComplex out1 = {real3, imag3};
+            vDSP_zvmaD(&in1, 1, &in2, 1, &out1, 1, &out1, 1, (vDSP_Length)vectorsize);
+#else
+            for(ulong i = 0; i < vectorsize; i++)
+            {
+                real3[i] += real1[i] * real2[i] - imag1[i] * imag2[i];
+                imag3[i] += real1[i] * imag2[i] + imag1[i] * real2[i];
+            }
+#endif
+        }
+        
+        static inline void vdecimate(const ulong vectorsize, const ulong factor, const float* in1, float* out1)
+        {
+            const float scale = 1.f / (float)factor;
+#ifdef __APPLE__
+            // The samples of each position in the groups are accumulated with a stride.
+            vDSP_vsmul(in1, (vDSP_Stride)factor, &scale, out1, 1, (vDSP_Length)vectorsize);
+            for(ulong j = 1; j < factor; j++)
+            {
+                vDSP_vsma(in1 + j, (vDSP_Stride)factor, &scale, out1, 1, out1, 1, (vDSP_Length)vectorsize);
+            }
+#else
+            for(ulong i = 0; i < vectorsize; i++, in1 += factor)
+            {
+                float sum = 0.f;
+                for(ulong j = 0; j < factor; j++)
+                {
+                    sum += in1[j];
+                }
+                out1[i] = sum * scale;
+            }
+#endif
+        }
+        
+        static inline void vdecimate(const ulong vectorsize, const ulong factor, const double* in1, double* out1)
+        {
+            const double scale = 1. / (double)factor;
+#ifdef __APPLE__
+            // The samples of each position in the groups are accumulated with a stride.
+            vDSP_vsmulD(in1, (vDSP_Stride)factor, &scale, out1, 1, (vDSP_Length)vectorsize);
+            for(ulong j = 1; j < factor; j++)
+            {
+                vDSP_vsmaD(in1 + j, (vDSP_Stride)factor, &scale, out1, 1, out1, 1, (vDSP_Length)vectorsize);
+            }
+#else
+            for(ulong i = 0; i < vectorsize; i++, in1 += factor)
+            {
+                double sum = 0.;
+                for(ulong j = 0; j < factor; j++)
+                {
+                    sum += in1[j];
+                }
+                out1[i] = sum * scale;
+            }
+#endif
+        }
+        
+        static inline float vinterpolate(const ulong vectorsize, const ulong factor, float last, const float* in1, float* out1)
+        {
+            const float scale = 1.f / (float)factor;
+#ifdef __APPLE__
+            // Each position in the groups interpolates between the consecutive inputs with
+            // the same ratio, the first group starts from the last sample.
+            if(!vectorsize)
+            {
+                return last;
+            }
+            for(ulong j = 0; j < factor; j++)
+            {
+                const float ratio = scale * (float)(j + 1);
+                out1[j] = last + (in1[0] - last) * ratio;
+                vDSP_vintb(in1, 1, in1 + 1, 1, &ratio, out1 + factor + j, (vDSP_Stride)factor, (vDSP_Length)(vectorsize - 1));
+            }
+            return in1[vectorsize - 1];
+#else
+            for(ulong i = 0; i < vectorsize; i++, out1 += factor)
+            {
+                const float step = (in1[i] - last) * scale;
+                for(ulong j = 0; j < factor; j++)
+                {
+                    out1[j] = last + step * (float)(j + 1);
+                }
+                last = in1[i];
+            }
+            return last;
+#endif
+        }
+        
+        static inline double vinterpolate(const ulong vectorsize, const ulong factor, double last, const double* in1, double* out1)
+        {
+            const double scale = 1. / (double)factor;
+#ifdef __APPLE__
+            // Each position in the groups interpolates between the consecutive inputs with
+            // the same ratio, the first group starts from the last sample.
+            if(!vectorsize)
+            {
+                return last;
+            }
+            for(ulong j = 0; j < factor; j++)
+            {
+                const double ratio = scale * (double)(j + 1);
+                out1[j] = last + (in1[0] - last) * ratio;
+                vDSP_vintbD(in1, 1, in1 + 1, 1, &ratio, out1 + factor + j, (vDSP_Stride)factor, (vDSP_Length)(vectorsize - 1));
+            }
+            return in1[vectorsize - 1];
+#else
+            for(ulong i = 0; i < vectorsize; i++, out1 += factor)
+            {
+                const double step = (in1[i] - last) * scale;
+                for(ulong j = 0; j < factor; j++)
+                {
+                    out1[j] = last + step * (double)(j + 1);
+                }
+                last = in1[i];
+            }
+            return last;
+#endif
+        }
+        
         static inline int vnoise(ulong vectorsize, int seed, float* out1)
         {
             while(vectorsize--)
@@ -341,6 +684,109 @@ namespace Kiwi
          return phase;
          }*/
     };
+    
+    // ================================================================================ //
+    //                                      DENORMALS                                   //
+    // ================================================================================ //
+    
+    //! The denormals flushes the denormal numbers to zero in its scope.
+    /**
+     The denormals sets the flush-to-zero and the denormals-are-zero modes of the floating point unit of the current thread when it's created and restores the previous modes when it's destroyed. The denormal numbers appear in the tails of the filters and of the feedback loops that decay to silence and they can cost tens of times a normal operation on x86 processors. On the other processors, only the flush-to-zero mode of arm processors is managed.
+     */
+    class Denormals
+    {
+    private:
+        const bool  m_flush;
+        ulong       m_state;
+        
+    public:
+        
+        //! Constructor.
+        /** The function saves the modes of the thread and flushes the denormals to zero.
+         @param flush False to do nothing.
+         */
+        inline Denormals(const bool flush = true) noexcept :
+        m_flush(flush),
+        m_state(0)
+        {
+            if(m_flush)
+            {
+                m_state = getState();
+                setState(m_state | getMask());
+            }
+        }
+        
+        //! Destructor.
+        /** The function restores the modes of the thread.
+         */
+        inline ~Denormals() noexcept
+        {
+            if(m_flush)
+            {
+                setState(m_state);
+            }
+        }
+        
+        //! Retrieve the modes of the floating point unit.
+        /** The function retrieves the control register of the floating point unit of the current thread.
+         @return The control register.
+         */
+        static inline ulong getState() noexcept
+        {
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+            return (ulong)_mm_getcsr();
+#elif defined(__aarch64__)
+            uint64_t state;
+            asm volatile("mrs %0, fpcr" : "=r"(state));
+            return (ulong)state;
+#elif defined(__arm__) && defined(__ARM_FP)
+            uint32_t state;
+            asm volatile("vmrs %0, fpscr" : "=r"(state));
+            return (ulong)state;
+#else
+            return 0;
+#endif
+        }
+        
+        //! Set the modes of the floating point unit.
+        /** The function sets the control register of the floating point unit of the current thread.
+         @param state The control register.
+         */
+        static inline void setState(const ulong state) noexcept
+        {
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+            _mm_setcsr((unsigned int)state);
+#elif defined(__aarch64__)
+            asm volatile("msr fpcr, %0" : : "r"((uint64_t)state));
+#elif defined(__arm__) && defined(__ARM_FP)
+            asm volatile("vmsr fpscr, %0" : : "r"((uint32_t)state));
+#endif
+        }
+        
+        //! Retrieve the flush modes.
+        /** The function retrieves the bits of the control register that flush the denormals to zero, the flush-to-zero and denormals-are-zero bits on x86 and the flush-to-zero bit on arm.
+         @return The bits of the flush modes.
+         */
+        static constexpr ulong getMask() noexcept
+        {
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+            return 0x8040;
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_FP))
+            return 1ul << 24;
+#else
+            return 0;
+#endif
+        }
+        
+        //! Check if the denormals are flushed to zero.
+        /** The function checks if the flush modes are set in the current thread.
+         @return True if the denormals are flushed to zero.
+         */
+        static inline bool isFlushing() noexcept
+        {
+            return getMask() && (getState() & getMask()) == getMask();
+        }
+    };
 }
 
 
@@ -0,0 +1,213 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspSpectral.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      STFT                                        //
+    // ================================================================================ //
+    
+    Stft::Stft(const ulong size, const ulong hop, const Window window) :
+    m_size(max(size + (size & 1), 2ul)),
+    m_hop(min(max(hop, 1ul), m_size)),
+    m_window_type(window),
+    m_fft(Fft::create(m_size)),
+    m_window(m_size),
+    m_synthesis(m_size),
+    m_input(m_size, 0.),
+    m_frame(m_size, 0.),
+    m_real(m_size / 2 + 1, 0.),
+    m_imag(m_size / 2 + 1, 0.),
+    m_output(m_size + m_hop, 0.),
+    m_nstages(3),
+    m_stage(3),
+    m_count(0),
+    m_write(0),
+    m_read(0),
+    m_target(0)
+    {
+        const double pi   = 3.14159265358979323846;
+        const double step = 2. * pi / double(m_size);
+        for(ulong i = 0; i < m_size; i++)
+        {
+            double value = 1.;
+            switch(m_window_type)
+            {
+                case Hann:
+                    value = 0.5 - 0.5 * cos(step * i);
+                    break;
+                case Hamming:
+                    value = 0.54 - 0.46 * cos(step * i);
+                    break;
+                case Blackman:
+                    value = 0.42 - 0.5 * cos(step * i) + 0.08 * cos(2. * step * i);
+                    break;
+                default:
+                    break;
+            }
+            m_window[i] = sample(value);
+        }
+        
+        // The window is applied before and after the transform, the synthesis window
+        // compensates the sum of the squared windows that overlap on each sample. The
+        // frames start every hop so the samples overlapped by the same window positions
+        // are the ones with the same position modulo the hop.
+        vector<double> overlap(m_hop, 0.);
+        for(ulong i = 0; i < m_size; i++)
+        {
+            overlap[i % m_hop] += double(m_window[i]) * double(m_window[i]);
+        }
+        for(ulong i = 0; i < m_size; i++)
+        {
+            const double sum = overlap[i % m_hop];
+            m_synthesis[i] = sum > 0. ? sample(double(m_window[i]) / sum) : sample(0.);
+        }
+    }
+    
+    Stft::~Stft()
+    {
+        ;
+    }
+    
+    void Stft::prepare(const ulong vectorsize) noexcept
+    {
+        Signal::vclear(m_size, m_input.data());
+        Signal::vclear(m_size + m_hop, m_output.data());
+        m_stage  = 3;
+        m_count  = 0;
+        m_write  = 0;
+        m_read   = 0;
+        m_target = 0;
+        
+        // The three stages of a frame are divided over the vectors of a hop.
+        const ulong nvectors = vectorsize ? max(m_hop / vectorsize, 1ul) : 1ul;
+        m_nstages = (3 + nvectors - 1) / nvectors;
+    }
+    
+    void Stft::run(Processor& processor, ulong nstages) noexcept
+    {
+        while(nstages-- && m_stage < 3)
+        {
+            switch(m_stage)
+            {
+                case 0:
+                    Signal::vmul(m_size, m_window.data(), m_frame.data());
+                    Fft::forward(*m_fft, m_frame.data(), m_real.data(), m_imag.data());
+                    break;
+                case 1:
+                    processor.process(m_real.data(), m_imag.data());
+                    break;
+                default:
+                {
+                    Fft::inverse(*m_fft, m_real.data(), m_imag.data(), m_frame.data());
+                    Signal::vmul(m_size, m_synthesis.data(), m_frame.data());
+                    const ulong length = m_size + m_hop;
+                    const ulong first  = min(m_size, length - m_target);
+                    Signal::vadd(first, m_frame.data(), m_output.data() + m_target);
+                    Signal::vadd(m_size - first, m_frame.data() + first, m_output.data());
+                }
+                    break;
+            }
+            m_stage++;
+        }
+    }
+    
+    void Stft::perform(Processor& processor, const sample* in1, sample* out1, const ulong vectorsize) noexcept
+    {
+        run(processor, m_nstages);
+        
+        const ulong length = m_size + m_hop;
+        ulong offset = 0;
+        while(offset < vectorsize)
+        {
+            const ulong size = min(vectorsize - offset, m_hop - m_count);
+            
+            // The input is recorded before the output is written because they can share the same vector.
+            const ulong first = min(size, m_size - m_write);
+            Signal::vcopy(first, in1 + offset, m_input.data() + m_write);
+            Signal::vcopy(size - first, in1 + offset + first, m_input.data());
+            m_write = (m_write + size) % m_size;
+            
+            const ulong second = min(size, length - m_read);
+            Signal::vcopy(second, m_output.data() + m_read, out1 + offset);
+            Signal::vclear(second, m_output.data() + m_read);
+            Signal::vcopy(size - second, m_output.data(), out1 + offset + second);
+            Signal::vclear(size - second, m_output.data());
+            m_read = (m_read + size) % length;
+            
+            offset  += size;
+            m_count += size;
+            if(m_count == m_hop)
+            {
+                // The previous frame must be finished before a new one starts, then the new
+                // frame is overlapped to the output one hop after the current position.
+                run(processor, 3);
+                Signal::vcopy(m_size - m_write, m_input.data() + m_write, m_frame.data());
+                Signal::vcopy(m_write, m_input.data(), m_frame.data() + m_size - m_write);
+                m_target = (m_read + m_hop) % length;
+                m_stage  = 0;
+                m_count  = 0;
+            }
+        }
+    }
+    
+    // ================================================================================ //
+    //                                      DSP SPECTRAL                                //
+    // ================================================================================ //
+    
+    DspSpectral::DspSpectral(sDspChain chain, const ulong size, const ulong hop, const Stft::Window window) : DspNode(chain, 1, 1),
+    m_stft(size, hop, window)
+    {
+        ;
+    }
+    
+    DspSpectral::~DspSpectral()
+    {
+        ;
+    }
+    
+    void DspSpectral::process(sample* real, sample* imag) noexcept
+    {
+        performSpectral(real, imag);
+    }
+    
+    void DspSpectral::prepare() noexcept
+    {
+        shouldPerform(isOutputConnected(0));
+        m_stft.prepare(getVectorSize());
+        prepareSpectral();
+    }
+    
+    void DspSpectral::perform() noexcept
+    {
+        m_stft.perform(*this, getInputsSamples()[0], getOutputsSamples()[0], getVectorSize());
+    }
+    
+    void DspSpectral::release() noexcept
+    {
+        releaseSpectral();
+    }
+}
+
@@ -0,0 +1,280 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_SPECTRAL__
+#define __DEF_KIWI_DSP_SPECTRAL__
+
+#include "DspNode.h"
+#include "DspFft.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      STFT                                        //
+    // ================================================================================ //
+    
+    //! The stft performs a short-time fourier analysis and resynthesis.
+    /**
+     The stft cuts a signal in overlapping windowed frames, gives the spectrum of each frame to a processor and resynthesizes the signal with a weighted overlap-add. The synthesis window is normalized by the sum of the squared windows that overlap on each sample so any window and hop reconstruct the signal, except the samples where no overlapped window is different from zero, like the first sample of each frame for the Hann window without overlap. The work of a frame is divided in three stages, the analysis, the processing and the synthesis, that are distributed over the vectors of a hop so the load of the audio thread stays flat. The frames are finished one hop after their end, so the latency is the size of the frame plus the hop. All the memory is allocated by the constructor.
+     */
+    class Stft
+    {
+    public:
+        
+        //! The windows of the stft.
+        enum Window
+        {
+            Rectangular = 0, ///< The rectangular window.
+            Hann        = 1, ///< The Hann window.
+            Hamming     = 2, ///< The Hamming window.
+            Blackman    = 3  ///< The Blackman window.
+        };
+        
+        //! The processor of the spectra.
+        /**
+         The processor receives the spectrum of each frame and modifies it in place.
+         */
+        class Processor
+        {
+        public:
+            
+            //! Destructor.
+            virtual ~Processor() { ; }
+            
+            //! Process a spectrum.
+            /** The method is called once per frame with the split complex spectrum, from the DC to the Nyquist frequency.
+             @param real The real part of the spectrum.
+             @param imag The imaginary part of the spectrum.
+             */
+            virtual void process(sample* real, sample* imag) noexcept = 0;
+        };
+    
+    private:
+        const ulong     m_size;
+        const ulong     m_hop;
+        const Window    m_window_type;
+        const sFftSetup m_fft;
+        vector<sample>  m_window;
+        vector<sample>  m_synthesis;
+        vector<sample>  m_input;
+        vector<sample>  m_frame;
+        vector<sample>  m_real;
+        vector<sample>  m_imag;
+        vector<sample>  m_output;
+        ulong           m_nstages;
+        ulong           m_stage;
+        ulong           m_count;
+        ulong           m_write;
+        ulong           m_read;
+        ulong           m_target;
+        
+        //! Run the pending stages of the current frame.
+        /** The function runs at most a number of stages of the current frame.
+         @param processor The processor.
+         @param nstages   The maximum number of stages.
+         */
+        void run(Processor& processor, ulong nstages) noexcept;
+    
+    public:
+        
+        //! Constructor.
+        /** The function allocates the buffers and the fft setup. An odd size is rounded up to the next even size and the hop is limited to the size.
+         @param size   The size of the frames and of the transform.
+         @param hop    The number of samples between two frames.
+         @param window The window.
+         */
+        Stft(const ulong size, const ulong hop, const Window window = Hann);
+        
+        //! Destructor.
+        /** Free the buffers.
+         */
+        ~Stft();
+        
+        //! Prepare the stft.
+        /** The function clears the buffers and divides the stages of a frame over the vectors of a hop. It doesn't allocate.
+         @param vectorsize The vector size.
+         */
+        void prepare(const ulong vectorsize) noexcept;
+        
+        //! Perform the stft.
+        /** The function analyses a vector, runs the due stages of the frames and writes a vector of the resynthesized signal. The input and the output can share the same vector.
+         @param processor  The processor.
+         @param in1        The input vector.
+         @param out1       The output vector.
+         @param vectorsize The vector size.
+         */
+        void perform(Processor& processor, const sample* in1, sample* out1, const ulong vectorsize) noexcept;
+        
+        //! Retrieve the size of the frames.
+        /** The function retrieves the size of the frames and of the transform.
+         @return The size of the frames.
+         */
+        inline ulong getSize() const noexcept
+        {
+            return m_size;
+        }
+        
+        //! Retrieve the hop.
+        /** The function retrieves the number of samples between two frames.
+         @return The hop.
+         */
+        inline ulong getHop() const noexcept
+        {
+            return m_hop;
+        }
+        
+        //! Retrieve the window.
+        /** The function retrieves the window of the frames.
+         @return The window.
+         */
+        inline Window getWindow() const noexcept
+        {
+            return m_window_type;
+        }
+        
+        //! Retrieve the number of bins.
+        /** The function retrieves the number of bins of the spectra.
+         @return The number of bins.
+         */
+        inline ulong getNumberOfBins() const noexcept
+        {
+            return m_size / 2 + 1;
+        }
+        
+        //! Retrieve the latency.
+        /** The function retrieves the number of samples between the input and the output.
+         @return The latency.
+         */
+        inline ulong getLatency() const noexcept
+        {
+            return m_size + m_hop;
+        }
+    };
+    
+    // ================================================================================ //
+    //                                      DSP SPECTRAL                                //
+    // ================================================================================ //
+    
+    //! The dsp spectral is the base of the nodes that process in the frequency domain.
+    /**
+     The dsp spectral is a node with one input and one output that owns a stft. The subclasses only have to process the spectrum of each frame, the analysis, the resynthesis and the scheduling of the frames are managed by the dsp spectral.
+     */
+    class DspSpectral : public DspNode, private Stft::Processor
+    {
+    private:
+        Stft m_stft;
+        
+        //! Process a spectrum.
+        /** The method gives the spectrum to the performSpectral method.
+         */
+        void process(sample* real, sample* imag) noexcept override;
+    
+    public:
+        
+        //! Constructor.
+        /** Create the node and its stft.
+         @param chain  The dsp chain.
+         @param size   The size of the frames.
+         @param hop    The number of samples between two frames.
+         @param window The window.
+         */
+        DspSpectral(sDspChain chain, const ulong size, const ulong hop, const Stft::Window window = Stft::Hann);
+        
+        //! Destructor.
+        virtual ~DspSpectral();
+        
+        //! Prepare the node.
+        /** The method prepares the stft and calls the prepareSpectral method.
+         */
+        void prepare() noexcept override;
+        
+        //! Perform the node.
+        /** The method performs the stft.
+         */
+        void perform() noexcept override;
+        
+        //! Release the node.
+        /** The method calls the releaseSpectral method.
+         */
+        void release() noexcept override;
+        
+        //! Retrieve the size of the frames.
+        /** The method retrieves the size of the frames and of the transform.
+         @return The size of the frames.
+         */
+        inline ulong getFrameSize() const noexcept
+        {
+            return m_stft.getSize();
+        }
+        
+        //! Retrieve the hop.
+        /** The method retrieves the number of samples between two frames.
+         @return The hop.
+         */
+        inline ulong getHop() const noexcept
+        {
+            return m_stft.getHop();
+        }
+        
+        //! Retrieve the number of bins.
+        /** The method retrieves the number of bins of the spectra.
+         @return The number of bins.
+         */
+        inline ulong getNumberOfBins() const noexcept
+        {
+            return m_stft.getNumberOfBins();
+        }
+        
+        //! Retrieve the latency.
+        /** The method retrieves the number of samples between the input and the output.
+         @return The latency.
+         */
+        inline ulong getLatency() const noexcept
+        {
+            return m_stft.getLatency();
+        }
+    
+    protected:
+        
+        //! Prepare the spectral process.
+        /** The method is called when the node is prepared, after the stft. By default, it does nothing.
+         */
+        virtual void prepareSpectral() noexcept { ; }
+        
+        //! Perform the spectral process.
+        /** The method is called once per frame with the split complex spectrum, from the DC to the Nyquist frequency, that should be modified in place.
+         @param real The real part of the spectrum.
+         @param imag The imaginary part of the spectrum.
+         */
+        virtual void performSpectral(sample* real, sample* imag) noexcept = 0;
+        
+        //! Release the spectral process.
+        /** The method is called when the node is released. By default, it does nothing.
+         */
+        virtual void releaseSpectral() noexcept { ; }
+    };
+}
+
+#endif
+
+
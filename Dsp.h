@@ -26,6 +26,7 @@
 
 #include "Modules/DspModules.h"
 #include "Context/DspDevice.h"
+#include "Context/DspSpectral.h"
 
 #endif
 
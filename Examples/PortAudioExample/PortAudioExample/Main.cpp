@@ -76,11 +76,13 @@ int main(int argc, const char * argv[])
             {
                 ctxt->add(chain);
                 sDspNode Noise = make_shared<DspNoise>(chain);
-                sDspNode Dac = make_shared<DspDac>(chain, vector<ulong>{(ulong)1, (ulong)2});
-                sDspLink cnectLeft = make_shared<DspLink>(chain, Noise, 0, Dac, 0);
-                sDspLink cnectRight = make_shared<DspLink>(chain, Noise, 0, Dac, 1);
+                sDspNode DacLeft = make_shared<DspDac>(chain, vector<ulong>{(ulong)1});
+                sDspNode DacRight = make_shared<DspDac>(chain, vector<ulong>{(ulong)2});
+                sDspLink cnectLeft = make_shared<DspLink>(chain, Noise, 0, DacLeft, 0);
+                sDspLink cnectRight = make_shared<DspLink>(chain, Noise, 0, DacRight, 0);
                 chain->add(Noise);
-                chain->add(Dac);
+                chain->add(DacLeft);
+                chain->add(DacRight);
                 chain->start();
                 chain->add(cnectRight);
                 
@@ -25,10 +25,15 @@
 
 namespace Kiwi
 {
+    const ulong JuceDeviceManager::c_channels;
+    
     JuceDeviceManager::JuceDeviceManager() :
     m_driver_name(""),
-    m_input_matrix(nullptr),
-    m_output_matrix(nullptr)
+    m_input_channels(new sample*[c_channels]()),
+    m_output_channels(new sample*[c_channels]()),
+    m_ninputs(0),
+    m_noutputs(0),
+    m_buffered(false)
     {
         m_setup.sampleRate = 44100;
         juce::AudioDeviceManager manager;
@@ -201,11 +206,20 @@ namespace Kiwi
         }
     }
     
+    void JuceDeviceManager::setBlockSize(ulong const blocksize)
+    {
+        if(blocksize != getBlockSize())
+        {
+            DspDeviceManager::setBlockSize(blocksize);
+            initialize();
+        }
+    }
+    
     sample const* JuceDeviceManager::getInputsSamples(const ulong channel) const noexcept
     {
-        if(m_input_matrix && channel < getNumberOfInputs())
+        if(channel < getNumberOfInputs() && channel < m_ninputs)
         {
-            return m_input_matrix[channel];
+            return m_input_channels[channel];
         }
         else
         {
@@ -215,9 +229,33 @@ namespace Kiwi
     
     sample* JuceDeviceManager::getOutputsSamples(const ulong channel) const noexcept
     {
-        if(m_output_matrix && channel < getNumberOfOutputs())
+        if(channel < getNumberOfOutputs() && channel < m_noutputs)
+        {
+            return m_output_channels[channel];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    sample const* const* JuceDeviceManager::getInputsBinding(const ulong channel) const noexcept
+    {
+        if(channel < getNumberOfInputs() && channel < m_ninputs)
+        {
+            return &m_input_channels[channel];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    sample* const* JuceDeviceManager::getOutputsBinding(const ulong channel) const noexcept
+    {
+        if(channel < getNumberOfOutputs() && channel < m_noutputs)
         {
-            return m_output_matrix[channel];
+            return &m_output_channels[channel];
         }
         else
         {
@@ -237,32 +275,6 @@ namespace Kiwi
             {
                 m_device->close();
             }
-            if(m_input_matrix)
-            {
-                for(int i = 0; i < m_device->getInputChannelNames().size(); i++)
-                {
-                    if(m_input_matrix[i])
-                    {
-                        delete [] m_input_matrix[i];
-                    }
-                    m_input_matrix[i] = nullptr;
-                }
-                delete [] m_input_matrix;
-            }
-            m_input_matrix = nullptr;
-            if(m_output_matrix)
-            {
-                for(int i = 0; i < m_device->getOutputChannelNames().size(); i++)
-                {
-                    if(m_output_matrix[i])
-                    {
-                        delete [] m_output_matrix[i];
-                    }
-                    m_output_matrix[i] = nullptr;
-                }
-                delete [] m_output_matrix;
-            }
-            m_output_matrix = nullptr;
         }
     }
     
@@ -345,17 +357,26 @@ namespace Kiwi
         m_setup.inputChannels = m_device->getActiveInputChannels();
         m_setup.outputChannels = m_device->getActiveOutputChannels();
         
-        m_input_matrix = new sample*[m_setup.inputChannels.getHighestBit() + 1];
-        for(int i = 0; i < m_setup.inputChannels.getHighestBit() + 1; i++)
+        const ulong nins        = getNumberOfInputs();
+        const ulong nouts       = getNumberOfOutputs();
+        
+        // The tables of the channels are allocated once so the bindings of the nodes never
+        // move, the chains aren't prepared again if only the channels change. The number
+        // of channels used only grows so a binding always points to a buffer of the blocks.
+        m_ninputs   = max(m_ninputs, min(nins, c_channels));
+        m_noutputs  = max(m_noutputs, min(nouts, c_channels));
+        prepareBlocks(m_ninputs, m_noutputs);
+        for(ulong i = 0; i < m_ninputs; i++)
         {
-            m_input_matrix[i] = new sample[m_setup.bufferSize];
+            m_input_channels[i] = getBlockInputs(i);
         }
-        m_output_matrix = new sample*[m_setup.outputChannels.getHighestBit() + 1];
-        for(int i = 0; i < m_setup.outputChannels.getHighestBit() + 1; i++)
+        for(ulong i = 0; i < m_noutputs; i++)
         {
-            m_output_matrix[i] = new sample[m_setup.bufferSize];
-            Signal::vclear(m_setup.bufferSize, m_output_matrix[i]);
+            m_output_channels[i] = getBlockOutputs(i);
         }
+        m_buffered = getLatency() != 0;
+        prepareOutputs(nouts);
+        resize().wait();
     }
     
     void JuceDeviceManager::audioDeviceStopped()
@@ -365,45 +386,91 @@ namespace Kiwi
     
     void JuceDeviceManager::audioDeviceIOCallback(const float** inputChannelData, int numInputChannels, float** outputChannelData, int numOutputChannels, int numSamples)
     {
-#ifdef __KIWI_DSP_DOUBLE__
-        for(int i = 0; i < numInputChannels; i++)
+        const ulong blocksize   = getBlockSize();
+        const ulong size        = (ulong)max(numSamples, 0);
+        const ulong nins        = min((ulong)max(numInputChannels, 0), m_ninputs);
+        const ulong nouts       = min((ulong)max(numOutputChannels, 0), m_noutputs);
+        
+        // If the number of samples isn't a multiple of the block size, the blocks are
+        // buffered by the reblocking until the device restarts.
+        if(!m_buffered && blocksize && (size % blocksize))
         {
-            sample* input = m_input_matrix[i];
-            float* real = inputChannelData[i];
-            for(int j = 0; j < numSamples; j++)
+            m_buffered = true;
+            for(ulong i = 0; i < m_ninputs; i++)
             {
-                *(input++) = *(real++);
+                m_input_channels[i] = getBlockInputs(i);
             }
-        }
-        for(int i = 0; i < numOutputChannels; i++)
-        {
-            Signal::vclear(numSamples, m_output_matrix[i]);
-        }
-        tick();
-        for(int i = 0; i < numOutputChannels; i++)
-        {
-            sample* output = m_output_matrix[i];
-            float* real = outputChannelData[i];
-            for(int j = 0; j < numSamples; j++)
+            for(ulong i = 0; i < m_noutputs; i++)
             {
-                *(real++) = *(output++);
+                m_output_channels[i] = getBlockOutputs(i);
             }
         }
-#else
-        for(int i = 0; i < numInputChannels; i++)
+        
+        if(!m_buffered)
         {
-            Signal::vcopy(numSamples, inputChannelData[i], m_input_matrix[i]);
+            for(ulong offset = 0; offset < size; offset += blocksize)
+            {
+#ifdef __KIWI_DSP_DOUBLE__
+                for(ulong i = 0; i < nins; i++)
+                {
+                    if(inputChannelData[i])
+                    {
+                        Signal::vcopy(blocksize, inputChannelData[i] + offset, m_input_channels[i]);
+                    }
+                    else
+                    {
+                        Signal::vclear(blocksize, m_input_channels[i]);
+                    }
+                }
+                tick();
+                for(ulong i = 0; i < nouts; i++)
+                {
+                    if(outputChannelData[i])
+                    {
+                        if(isOutputWritten(i))
+                        {
+                            Signal::vcopy(blocksize, m_output_channels[i], outputChannelData[i] + offset);
+                        }
+                        else
+                        {
+                            Signal::vclear(blocksize, outputChannelData[i] + offset);
+                        }
+                    }
+                }
+#else
+                // The channels are bound to the buffers of the host for the block, the missing
+                // channels use the buffers of the blocks.
+                for(ulong i = 0; i < m_ninputs; i++)
+                {
+                    m_input_channels[i] = (i < nins && inputChannelData[i]) ? const_cast<sample*>(inputChannelData[i]) + offset : getBlockInputs(i);
+                }
+                for(ulong i = 0; i < m_noutputs; i++)
+                {
+                    m_output_channels[i] = (i < nouts && outputChannelData[i]) ? outputChannelData[i] + offset : getBlockOutputs(i);
+                }
+                tick();
+                for(ulong i = 0; i < nouts; i++)
+                {
+                    if(!isOutputWritten(i))
+                    {
+                        Signal::vclear(blocksize, m_output_channels[i]);
+                    }
+                }
+#endif
+            }
         }
-        tick();
-        for(int i = 0; i < numOutputChannels; i++)
+        else
         {
-            Signal::vcopy(numSamples, m_output_matrix[i], outputChannelData[i]);
+            process(size, nins, inputChannelData, nouts, outputChannelData);
         }
-        for(int i = 0; i < numOutputChannels; i++)
+        
+        for(int i = (int)nouts; i < numOutputChannels; i++)
         {
-            Signal::vclear(numSamples, m_output_matrix[i]);
+            if(outputChannelData[i])
+            {
+                Signal::vclear(size, outputChannelData[i]);
+            }
         }
-#endif
     }
 }
 
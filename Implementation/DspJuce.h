@@ -35,8 +35,13 @@ namespace Kiwi
         string                                      m_driver_name;
         juce::ScopedPointer<juce::AudioIODevice>    m_device;
         juce::AudioDeviceManager::AudioDeviceSetup  m_setup;
-        sample**                                    m_input_matrix;
-        sample**                                    m_output_matrix;
+        const unique_ptr<sample*[]>                 m_input_channels;
+        const unique_ptr<sample*[]>                 m_output_channels;
+        ulong                                       m_ninputs;
+        ulong                                       m_noutputs;
+        bool                                        m_buffered;
+        
+        static const ulong c_channels = 256;
         
         void initialize();
         
@@ -162,6 +167,12 @@ namespace Kiwi
          */
         void setVectorSize(ulong const vectorsize) override;
         
+        //! Set the block size.
+        /** This function sets the block size and restarts the device.
+         @param blocksize The block size.
+         */
+        void setBlockSize(ulong const blocksize) override;
+        
         //! Retrieve the inputs sample matrix.
         /** This function retrieves the inputs sample matrix.
          @param channel the index of the channel.
@@ -176,6 +187,20 @@ namespace Kiwi
          */
         sample* getOutputsSamples(const ulong channel) const noexcept override;
         
+        //! Retrieve the binding of an input channel.
+        /** This function retrieves the address of the pointer to the samples of an input channel. In single precision, the pointer is set to the buffer of the host at each cycle.
+         @param channel the index of the channel.
+         @return The address of the pointer to the samples or nullptr.
+         */
+        sample const* const* getInputsBinding(const ulong channel) const noexcept override;
+        
+        //! Retrieve the binding of an output channel.
+        /** This function retrieves the address of the pointer to the samples of an output channel. In single precision, the pointer is set to the buffer of the host at each cycle.
+         @param channel the index of the channel.
+         @return The address of the pointer to the samples or nullptr.
+         */
+        sample* const* getOutputsBinding(const ulong channel) const noexcept override;
+        
         void audioDeviceIOCallback(const float** inputChannelData, int numInputChannels, float** outputChannelData, int numOutputChannels, int numSamples) override;
         void audioDeviceAboutToStart(AudioIODevice* device) override;
         void audioDeviceStopped() override;
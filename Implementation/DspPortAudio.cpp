@@ -26,6 +26,7 @@
 namespace Kiwi
 {
     ulong PortAudioDeviceManager::m_nmanagers = 0;
+    const ulong PortAudioDeviceManager::c_channels;
     
     PortAudioDeviceManager::DeviceNode::DeviceNode(PortAudioDeviceManager* _device) :
     device(_device),
@@ -34,15 +35,29 @@ namespace Kiwi
     nouts(_device->m_paramoutput.channelCount),
     outputs(_device->m_sample_outs),
     samplerate(_device->m_samplerate),
-    vectorsize(_device->m_vectorsize)
+    vectorsize(_device->m_vectorsize),
+    layout(_device->m_layout),
+    reblocking(_device->getBlockSize() != _device->m_vectorsize)
     {
-        ;
+        for(ulong i = 0; i < nins; i++)
+        {
+            channels_ins.push_back(inputs + i * vectorsize);
+        }
+        for(ulong i = 0; i < nouts; i++)
+        {
+            channels_outs.push_back(outputs + i * vectorsize);
+        }
     }
     
     PortAudioDeviceManager::PortAudioDeviceManager() :
     m_stream(nullptr),
+    m_layout(Interleaved),
     m_sample_ins(nullptr),
-    m_sample_outs(nullptr)
+    m_sample_outs(nullptr),
+    m_input_channels(new sample*[c_channels]()),
+    m_output_channels(new sample*[c_channels]()),
+    m_ninputs(0),
+    m_noutputs(0)
     {
         lock_guard<mutex> guard(m_mutex);
         if(!m_nmanagers)
@@ -302,11 +317,20 @@ namespace Kiwi
         }
     }
     
+    void PortAudioDeviceManager::setBlockSize(ulong const blocksize)
+    {
+        if(blocksize != getBlockSize())
+        {
+            DspDeviceManager::setBlockSize(blocksize);
+            start();
+        }
+    }
+    
     sample const* PortAudioDeviceManager::getInputsSamples(const ulong channel) const noexcept
     {
-        if(m_sample_ins && channel < getNumberOfInputs())
+        if(channel < getNumberOfInputs() && channel < m_ninputs)
         {
-            return m_sample_ins + channel * getVectorSize();
+            return m_input_channels[channel];
         }
         else
         {
@@ -316,9 +340,9 @@ namespace Kiwi
     
     sample* PortAudioDeviceManager::getOutputsSamples(const ulong channel) const noexcept
     {
-        if(m_sample_outs && channel < getNumberOfOutputs())
+        if(channel < getNumberOfOutputs() && channel < m_noutputs)
         {
-            return m_sample_outs + channel * getVectorSize();
+            return m_output_channels[channel];
         }
         else
         {
@@ -326,6 +350,35 @@ namespace Kiwi
         }
     }
     
+    sample const* const* PortAudioDeviceManager::getInputsBinding(const ulong channel) const noexcept
+    {
+        if(channel < getNumberOfInputs() && channel < m_ninputs)
+        {
+            return &m_input_channels[channel];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    sample* const* PortAudioDeviceManager::getOutputsBinding(const ulong channel) const noexcept
+    {
+        if(channel < getNumberOfOutputs() && channel < m_noutputs)
+        {
+            return &m_output_channels[channel];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    
+    PortAudioDeviceManager::Layout PortAudioDeviceManager::getLayout() const noexcept
+    {
+        return m_layout;
+    }
+    
     void PortAudioDeviceManager::stop()
     {
         if(m_stream)
@@ -368,11 +421,54 @@ namespace Kiwi
             stop();
         }
 
-        m_sample_ins    = new sample[m_paraminput.channelCount * m_vectorsize];
-        m_sample_outs   = new sample[m_paramoutput.channelCount * m_vectorsize];
+        // The tables of the channels are allocated once so the bindings of the nodes never
+        // move, the chains aren't prepared again if only the channels change. The number
+        // of channels used only grows so a binding always points to a buffer.
+        const ulong nins    = (ulong)m_paraminput.channelCount;
+        const ulong nouts   = (ulong)m_paramoutput.channelCount;
+        m_ninputs   = max(m_ninputs, min(nins, c_channels));
+        m_noutputs  = max(m_noutputs, min(nouts, c_channels));
+        m_sample_ins    = new sample[max(nins, m_ninputs) * m_vectorsize];
+        m_sample_outs   = new sample[max(nouts, m_noutputs) * m_vectorsize];
+        prepareOutputs(nouts);
+        prepareBlocks(max(nins, m_ninputs), max(nouts, m_noutputs));
+        const bool reblocking = getBlockSize() != m_vectorsize;
+        for(ulong i = 0; i < m_ninputs; i++)
+        {
+            m_input_channels[i] = reblocking ? getBlockInputs(i) : m_sample_ins + i * m_vectorsize;
+        }
+        for(ulong i = 0; i < m_noutputs; i++)
+        {
+            m_output_channels[i] = reblocking ? getBlockOutputs(i) : m_sample_outs + i * m_vectorsize;
+        }
+        
+        // The chains are resized while the stream is opened and only started once they're ready.
+        future<void> resized = resize();
+        
+        // The non-interleaved buffers are requested first, the interleaved buffers are
+        // only used if the host api doesn't support them.
+        m_layout = NonInterleaved;
+        m_paraminput.sampleFormat   = paFloat32 | paNonInterleaved;
+        m_paramoutput.sampleFormat  = paFloat32 | paNonInterleaved;
+        if(Pa_IsFormatSupported(&m_paraminput, &m_paramoutput, m_samplerate) != paFormatIsSupported)
+        {
+            m_layout = Interleaved;
+            m_paraminput.sampleFormat   = paFloat32;
+            m_paramoutput.sampleFormat  = paFloat32;
+        }
         
         DeviceNode* node = new DeviceNode(this);
         PaError err = Pa_OpenStream(&m_stream, &m_paraminput, &m_paramoutput, m_samplerate, m_vectorsize, paClipOff, &callback, node);
+        if(err != paNoError && m_layout == NonInterleaved)
+        {
+            delete node;
+            m_layout = Interleaved;
+            m_paraminput.sampleFormat   = paFloat32;
+            m_paramoutput.sampleFormat  = paFloat32;
+            node = new DeviceNode(this);
+            err = Pa_OpenStream(&m_stream, &m_paraminput, &m_paramoutput, m_samplerate, m_vectorsize, paClipOff, &callback, node);
+        }
+        resized.wait();
         if(err != paNoError)
         {
             cout << "PortAudio error: %s\n" << Pa_GetErrorText(err) << endl;
@@ -399,38 +495,84 @@ namespace Kiwi
     int PortAudioDeviceManager::callback(const void *inputBuffer, void *outputBuffer, ulong framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags, void *userData)
     {
         DeviceNode* d = (DeviceNode*)userData;
-#ifdef __KIWI_DSP_DOUBLE__
         const ulong nins    = d->nins;
         const ulong nouts   = d->nouts;
         const ulong vecsize = d->vectorsize;
-        float*  vec1     = (float*)inputBuffer;
-        sample* vec2     = d->inputs;
-        
-        for(ulong i = 0; i < nins; i++)
+        if(d->reblocking)
         {
-            for(ulong j = 0; j < vecsize; j++)
+            // The blocks are buffered when the block size isn't the vector size of the stream,
+            // the interleaved buffers are transposed around the reblocking.
+            if(d->layout == NonInterleaved)
             {
-                *(vec2++) = *(vec1+nins+j*nins);
+                d->device->process(vecsize, nins, (const float* const*)inputBuffer, nouts, (float* const*)outputBuffer);
+            }
+            else
+            {
+                Signal::vdeterleave(vecsize, nins, (const float*)inputBuffer, d->inputs);
+                d->device->process(vecsize, nins, d->channels_ins.data(), nouts, d->channels_outs.data());
+                Signal::vinterleave(vecsize, nouts, d->outputs, (float*)outputBuffer);
             }
         }
-        Signal::vclear(d->vectorsize * d->nouts, d->outputs);
-        d->device->tick();
-        
-        vec2    = d->outputs;
-        vec1    = (float*)inputBuffer;
-        for(ulong i = 0; i < nouts; i++)
+        else if(d->layout == NonInterleaved)
         {
-            for(ulong j = 0; j < vecsize; j++)
+            const float* const* ins = (const float* const*)inputBuffer;
+            float* const* outs      = (float* const*)outputBuffer;
+#ifdef __KIWI_DSP_DOUBLE__
+            // The samples of the engine are in double precision so the buffers of the
+            // channels are converted.
+            for(ulong i = 0; i < nins; i++)
             {
-                *(vec1++) = *(vec2+nouts+j*nouts);
+                Signal::vcopy(vecsize, ins[i], d->inputs + i * vecsize);
+            }
+            d->device->tick();
+            for(ulong i = 0; i < nouts; i++)
+            {
+                if(d->device->isOutputWritten(i))
+                {
+                    Signal::vcopy(vecsize, d->outputs + i * vecsize, outs[i]);
+                }
+                else
+                {
+                    Signal::vclear(vecsize, outs[i]);
+                }
             }
-        }
 #else
-        Signal::vdeterleave(d->vectorsize, d->nins, (float *)inputBuffer, d->inputs);
-        Signal::vclear(d->vectorsize * d->nouts, d->outputs);
-        d->device->tick();
-        Signal::vinterleave(d->vectorsize, d->nouts, (float *)d->outputs, (float *)outputBuffer);
+            // The channels are bound to the buffers of the stream for the cycle, the
+            // outputs that no node has written are cleared.
+            const ulong nbound = min(nouts, d->device->m_noutputs);
+            for(ulong i = 0; i < nins && i < d->device->m_ninputs; i++)
+            {
+                d->device->m_input_channels[i] = const_cast<sample*>(ins[i]);
+            }
+            for(ulong i = 0; i < nbound; i++)
+            {
+                d->device->m_output_channels[i] = outs[i];
+            }
+            d->device->tick();
+            for(ulong i = 0; i < nouts; i++)
+            {
+                if(i >= nbound || !d->device->isOutputWritten(i))
+                {
+                    Signal::vclear(vecsize, outs[i]);
+                }
+            }
 #endif
+        }
+        else
+        {
+            // The channels that no node has written are cleared before the transposition.
+            float* out = (float*)outputBuffer;
+            Signal::vdeterleave(vecsize, nins, (const float*)inputBuffer, d->inputs);
+            d->device->tick();
+            for(ulong i = 0; i < nouts; i++)
+            {
+                if(!d->device->isOutputWritten(i))
+                {
+                    Signal::vclear(vecsize, d->outputs + i * vecsize);
+                }
+            }
+            Signal::vinterleave(vecsize, nouts, d->outputs, out);
+        }
         return paContinue;
     }
     
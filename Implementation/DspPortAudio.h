@@ -31,6 +31,16 @@ namespace Kiwi
 {
     class PortAudioDeviceManager : public DspDeviceManager
     {
+    public:
+        
+        //! The layouts of the buffers of the stream.
+        enum Layout
+        {
+            Interleaved     = 0, ///< The channels are interleaved and transposed around each tick.
+            NonInterleaved  = 1  ///< The stream has one buffer per channel that the channels use directly.
+        };
+        
+    private:
         struct DeviceNode
         {
             const PortAudioDeviceManager*      device;
@@ -40,11 +50,16 @@ namespace Kiwi
             sample *const                      outputs;
             const ulong                        samplerate;
             const ulong                        vectorsize;
+            const Layout                       layout;
+            const bool                         reblocking;
+            vector<const sample*>              channels_ins;
+            vector<sample*>                    channels_outs;
             
             DeviceNode(PortAudioDeviceManager* _device);
         };
         
         static ulong        m_nmanagers;
+        static const ulong  c_channels = 256;
 
         PaHostApiIndex      m_driver;
         PaStreamParameters  m_paraminput;
@@ -53,8 +68,13 @@ namespace Kiwi
         ulong               m_vectorsize;
         
         PaStream*           m_stream;
+        Layout              m_layout;
         sample*             m_sample_ins;
         sample*             m_sample_outs;
+        const unique_ptr<sample*[]> m_input_channels;
+        const unique_ptr<sample*[]> m_output_channels;
+        ulong               m_ninputs;
+        ulong               m_noutputs;
         vector<sDspContext> m_contexts;
         mutable mutex       m_mutex;
         
@@ -184,6 +204,12 @@ namespace Kiwi
          */
         void setSampleRate(ulong const samplerate) override;
         
+        //! Set the block size.
+        /** This function sets the block size and restarts the stream.
+         @param blocksize The block size.
+         */
+        void setBlockSize(ulong const blocksize) override;
+        
         //! Retrieve the inputs sample matrix.
         /** This function retrieves the inputs sample matrix.
          @param channel the index of the channel.
@@ -197,6 +223,26 @@ namespace Kiwi
          @return The outputs sample matrix.
          */
         sample* getOutputsSamples(const ulong channel) const noexcept override;
+        
+        //! Retrieve the binding of an input channel.
+        /** This function retrieves the address of the pointer to the samples of an input channel. In single precision with the non-interleaved buffers, the pointer is set to the buffer of the stream at each cycle.
+         @param channel the index of the channel.
+         @return The address of the pointer to the samples or nullptr.
+         */
+        sample const* const* getInputsBinding(const ulong channel) const noexcept override;
+        
+        //! Retrieve the binding of an output channel.
+        /** This function retrieves the address of the pointer to the samples of an output channel. In single precision with the non-interleaved buffers, the pointer is set to the buffer of the stream at each cycle.
+         @param channel the index of the channel.
+         @return The address of the pointer to the samples or nullptr.
+         */
+        sample* const* getOutputsBinding(const ulong channel) const noexcept override;
+        
+        //! Retrieve the layout of the buffers of the stream.
+        /** This function retrieves if the stream has been opened with non-interleaved buffers, that are copied directly to the channels, or with interleaved buffers, that have to be transposed because the host api doesn't support the non-interleaved buffers.
+         @return The layout of the stream.
+         */
+        Layout getLayout() const noexcept;
     };
 }
 
@@ -0,0 +1,359 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspConvolution.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      CONVOLUTION                                 //
+    // ================================================================================ //
+    
+    DspConvolution::Uniform::Uniform(const ulong size, const sample* response, const ulong length) :
+    m_size(size),
+    m_nbins(size + 1),
+    m_npartitions((length + size - 1) / size),
+    m_fft(Fft::create(size * 2)),
+    m_spectra_real(m_npartitions * m_nbins),
+    m_spectra_imag(m_npartitions * m_nbins),
+    m_fdl_real(m_npartitions * m_nbins, 0.),
+    m_fdl_imag(m_npartitions * m_nbins, 0.),
+    m_accum_real(m_nbins),
+    m_accum_imag(m_nbins),
+    m_input(size * 2, 0.),
+    m_output(size * 2),
+    m_index(0)
+    {
+        vector<sample> temp(size * 2);
+        for(ulong i = 0; i < m_npartitions; i++)
+        {
+            const ulong offset = i * size;
+            Signal::vclear(size * 2, temp.data());
+            Signal::vcopy(min(size, length - offset), response + offset, temp.data());
+            Fft::forward(*m_fft, temp.data(), m_spectra_real.data() + i * m_nbins, m_spectra_imag.data() + i * m_nbins);
+        }
+    }
+    
+    void DspConvolution::Uniform::process(const sample* in1, sample* out1) noexcept
+    {
+        if(!m_npartitions)
+        {
+            Signal::vclear(m_size, out1);
+            return;
+        }
+        
+        Signal::vcopy(m_size, m_input.data() + m_size, m_input.data());
+        Signal::vcopy(m_size, in1, m_input.data() + m_size);
+        
+        m_index = m_index ? m_index - 1 : m_npartitions - 1;
+        sample* fdlr = m_fdl_real.data();
+        sample* fdli = m_fdl_imag.data();
+        const sample* hr = m_spectra_real.data();
+        const sample* hi = m_spectra_imag.data();
+        Fft::forward(*m_fft, m_input.data(), fdlr + m_index * m_nbins, fdli + m_index * m_nbins);
+        
+        // The partition i is applied to the spectrum of the input of i vectors ago.
+        Signal::vclear(m_nbins, m_accum_real.data());
+        Signal::vclear(m_nbins, m_accum_imag.data());
+        const ulong split = m_npartitions - m_index;
+        for(ulong i = 0; i < split; i++)
+        {
+            const ulong slot = (m_index + i) * m_nbins;
+            Signal::vcmuladd(m_nbins, fdlr + slot, fdli + slot, hr + i * m_nbins, hi + i * m_nbins, m_accum_real.data(), m_accum_imag.data());
+        }
+        for(ulong i = split; i < m_npartitions; i++)
+        {
+            const ulong slot = (i - split) * m_nbins;
+            Signal::vcmuladd(m_nbins, fdlr + slot, fdli + slot, hr + i * m_nbins, hi + i * m_nbins, m_accum_real.data(), m_accum_imag.data());
+        }
+        
+        Fft::inverse(*m_fft, m_accum_real.data(), m_accum_imag.data(), m_output.data());
+        Signal::vcopy(m_size, m_output.data() + m_size, out1);
+    }
+    
+    DspConvolution::Engine::Engine(const ulong size, const ulong samplerate, vector<sample> const& response, atomic_ulong& misses, scDspDeviceManager device) :
+    m_size(size),
+    m_tail_size(0),
+    m_tail_output(nullptr),
+    m_tail_index(0),
+    m_expected(0),
+    m_submitted(0),
+    m_completed(0),
+    m_exit(false),
+    m_misses(misses),
+    m_timeout(1000),
+    m_denormals(device ? device->isFlushingDenormals() : true),
+    m_device(device)
+    {
+        if(device)
+        {
+            m_realtime = device->getRealTime();
+            if(m_realtime.policy != DspDeviceManager::RealTime::Default && m_realtime.priority > 1)
+            {
+                m_realtime.priority--;
+            }
+        }
+        
+        // The tail partitions are used when the response is long enough to need at least six of them.
+        // The head covers the two first tail periods so the background thread has one period to work.
+        const ulong length = (ulong)response.size();
+        ulong tail = size;
+        while(tail < 4096 && tail * 8 <= length)
+        {
+            tail *= 2;
+        }
+        if(tail > size)
+        {
+            m_tail_size = tail;
+            if(samplerate)
+            {
+                m_timeout = chrono::microseconds(max(m_tail_size * 250000 / samplerate, 1ul));
+            }
+        }
+        const ulong head = m_tail_size ? m_tail_size * 2 : length;
+        m_head = unique_ptr<Uniform>(new Uniform(size, response.data(), head));
+        if(m_tail_size)
+        {
+            m_tail = unique_ptr<Uniform>(new Uniform(m_tail_size, response.data() + head, length - head));
+            m_tail_input.resize(m_tail_size, 0.);
+            m_tail_jobs.resize(m_tail_size * c_njobs, 0.);
+            m_tail_results.resize(m_tail_size * c_njobs, 0.);
+            m_worker = thread(&Engine::work, this);
+        }
+    }
+    
+    DspConvolution::Engine::~Engine()
+    {
+        if(m_worker.joinable())
+        {
+            {
+                lock_guard<mutex> guard(m_mutex);
+                m_exit = true;
+            }
+            m_condition.notify_one();
+            m_worker.join();
+        }
+    }
+    
+    void DspConvolution::Engine::retire() noexcept
+    {
+        // The audio thread doesn't lock the mutex, if the background thread misses this
+        // notification, it sees the flag after its timeout.
+        m_exit = true;
+        m_condition.notify_one();
+    }
+    
+    void DspConvolution::Engine::work() noexcept
+    {
+        Denormals denormals(m_denormals);
+        const ulong failures = m_realtime.apply();
+        scDspDeviceManager device = m_device.lock();
+        if(failures && device)
+        {
+            device->reportRealTimeFailures(failures);
+        }
+        unique_lock<mutex> lock(m_mutex);
+        while(true)
+        {
+            // The audio thread notifies without the mutex so a notification can be lost
+            // while the condition is checked, the condition is then checked again after a
+            // quarter of a tail period and the job is only delayed.
+            m_condition.wait_for(lock, m_timeout, [this]()
+            {
+                return m_exit || m_completed != m_submitted;
+            });
+            if(m_exit)
+            {
+                break;
+            }
+            else if(m_completed == m_submitted)
+            {
+                continue;
+            }
+            
+            // The jobs are processed in order so the tail receives all the periods.
+            lock.unlock();
+            const ulong job = (m_completed % c_njobs) * m_tail_size;
+            m_tail->process(m_tail_jobs.data() + job, m_tail_results.data() + job);
+            m_completed.fetch_add(1, memory_order_release);
+            lock.lock();
+        }
+    }
+    
+    void DspConvolution::Engine::process(const sample* in1, sample* out1) noexcept
+    {
+        if(!m_tail)
+        {
+            m_head->process(in1, out1);
+            return;
+        }
+        
+        // The input is recorded before the head because the output can share its vector.
+        Signal::vcopy(m_size, in1, m_tail_input.data() + m_tail_index);
+        m_head->process(in1, out1);
+        if(m_tail_output)
+        {
+            Signal::vadd(m_size, m_tail_output + m_tail_index, out1);
+        }
+        m_tail_index += m_size;
+        
+        if(m_tail_index == m_tail_size)
+        {
+            // The result of the job of the previous period is due, if the background thread
+            // is late the tail of the next period is dropped. Its slot isn't reused before
+            // two other jobs are submitted so it can be read during the next period.
+            const ulong completed = m_completed.load(memory_order_acquire);
+            const ulong submitted = m_submitted.load(memory_order_relaxed);
+            m_tail_output = nullptr;
+            if(m_expected)
+            {
+                if(completed >= m_expected)
+                {
+                    m_tail_output = m_tail_results.data() + ((m_expected - 1) % c_njobs) * m_tail_size;
+                }
+                else
+                {
+                    m_misses++;
+                }
+            }
+            
+            // If all the slots are still used by the background thread, the input of the
+            // period is dropped too.
+            if(submitted - completed < c_njobs)
+            {
+                Signal::vcopy(m_tail_size, m_tail_input.data(), m_tail_jobs.data() + (submitted % c_njobs) * m_tail_size);
+                m_submitted.store(submitted + 1, memory_order_release);
+                m_expected = submitted + 1;
+                m_condition.notify_one();
+            }
+            else
+            {
+                m_expected = 0;
+                m_misses++;
+            }
+            m_tail_index = 0;
+        }
+    }
+    
+    DspConvolution::DspConvolution(sDspChain chain, vector<sample> const& response) noexcept : DspNode(chain, 1, 1),
+    m_response(response),
+    m_ready(false),
+    m_misses(0)
+    {
+        ;
+    }
+    
+    DspConvolution::~DspConvolution()
+    {
+        ;
+    }
+    
+    string DspConvolution::getName() const noexcept
+    {
+        return "Convolution";
+    }
+    
+    void DspConvolution::post(unique_ptr<Engine> engine)
+    {
+        // The previous pending engine or the engine released by the audio thread is freed here.
+        lock_guard<mutex> guard(m_swap);
+        m_pending = move(engine);
+        m_ready   = true;
+    }
+    
+    void DspConvolution::prepare() noexcept
+    {
+        shouldPerform(isOutputConnected(0));
+        lock_guard<mutex> guard(m_mutex);
+        {
+            lock_guard<mutex> swap(m_swap);
+            if(m_ready)
+            {
+                m_engine.swap(m_pending);
+                m_ready = false;
+                m_pending.reset();
+            }
+        }
+        if(!m_engine || m_engine->getSize() != getVectorSize())
+        {
+            try
+            {
+                m_engine = unique_ptr<Engine>(new Engine(getVectorSize(), getSampleRate(), m_response, m_misses, getDeviceManager()));
+            }
+            catch(bad_alloc& e)
+            {
+                m_engine.reset();
+                shouldPerform(false);
+            }
+            catch(system_error& e)
+            {
+                // The background thread couldn't be created.
+                m_engine.reset();
+                shouldPerform(false);
+            }
+        }
+    }
+    
+    void DspConvolution::perform() noexcept
+    {
+        if(m_ready && m_swap.try_lock())
+        {
+            if(m_ready && m_pending->getSize() == getVectorSize())
+            {
+                // The previous engine stops its background thread and it's freed by the next post.
+                m_engine.swap(m_pending);
+                m_ready = false;
+                m_pending->retire();
+            }
+            m_swap.unlock();
+        }
+        m_engine->process(getInputsSamples()[0], getOutputsSamples()[0]);
+    }
+    
+    void DspConvolution::release() noexcept
+    {
+        ;
+    }
+    
+    void DspConvolution::setResponse(vector<sample> const& response)
+    {
+        lock_guard<mutex> guard(m_mutex);
+        m_response = response;
+        const ulong size = getVectorSize();
+        if(size)
+        {
+            post(unique_ptr<Engine>(new Engine(size, getSampleRate(), m_response, m_misses, getDeviceManager())));
+        }
+    }
+    
+    void DspConvolution::getResponse(vector<sample>& response) const
+    {
+        lock_guard<mutex> guard(m_mutex);
+        response = m_response;
+    }
+    
+    ulong DspConvolution::getNumberOfMisses() const noexcept
+    {
+        return m_misses;
+    }
+}
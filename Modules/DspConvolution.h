@@ -0,0 +1,126 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_CONVOLUTION__
+#define __DEF_KIWI_DSP_CONVOLUTION__
+
+#include "../Context/DspDevice.h"
+#include "../Context/DspFft.h"
+#include <condition_variable>
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      CONVOLUTION                                 //
+    // ================================================================================ //
+    
+    //! The convolution node performs a non-uniformly partitioned convolution.
+    /**
+     The convolution node convolves its input with an impulse response in the frequency domain with an overlap-save scheme. The head of the impulse response is cut in partitions of the vector size and processed in the audio thread so the node doesn't add latency. For long impulse responses, the tail is cut in larger partitions that are processed by a background thread during the period of a tail partition. The audio thread never waits for the background thread: if the result of a tail partition isn't ready at its deadline, the tail of the period is dropped and counted as a miss, and the background thread catches up with the following partitions. The background thread flushes the denormals to zero like the audio thread if the device manager does, and it uses the real-time settings of the device manager with a priority just below the one of the audio thread. The spectra of the partitions are computed by the thread that sets the impulse response or prepares the node, never by the audio thread, and the new engine is handed to the audio thread without lock.
+     */
+    class DspConvolution : public DspNode
+    {
+    private:
+        class Uniform
+        {
+        private:
+            const ulong     m_size;
+            const ulong     m_nbins;
+            const ulong     m_npartitions;
+            const sFftSetup m_fft;
+            vector<sample>  m_spectra_real;
+            vector<sample>  m_spectra_imag;
+            vector<sample>  m_fdl_real;
+            vector<sample>  m_fdl_imag;
+            vector<sample>  m_accum_real;
+            vector<sample>  m_accum_imag;
+            vector<sample>  m_input;
+            vector<sample>  m_output;
+            ulong           m_index;
+        public:
+            Uniform(const ulong size, const sample* response, const ulong length);
+            void process(const sample* in1, sample* out1) noexcept;
+        };
+        
+        class Engine
+        {
+        private:
+            static const ulong c_njobs = 3;
+            
+            const ulong         m_size;
+            ulong               m_tail_size;
+            unique_ptr<Uniform> m_head;
+            unique_ptr<Uniform> m_tail;
+            vector<sample>      m_tail_input;
+            vector<sample>      m_tail_jobs;
+            vector<sample>      m_tail_results;
+            const sample*       m_tail_output;
+            ulong               m_tail_index;
+            ulong               m_expected;
+            atomic_ulong        m_submitted;
+            atomic_ulong        m_completed;
+            atomic_bool         m_exit;
+            atomic_ulong&       m_misses;
+            chrono::microseconds m_timeout;
+            bool                m_denormals;
+            wcDspDeviceManager  m_device;
+            DspDeviceManager::RealTime m_realtime;
+            mutex               m_mutex;
+            condition_variable  m_condition;
+            thread              m_worker;
+            
+            void work() noexcept;
+        public:
+            Engine(const ulong size, const ulong samplerate, vector<sample> const& response, atomic_ulong& misses, scDspDeviceManager device);
+            ~Engine();
+            inline ulong getSize() const noexcept {return m_size;}
+            inline ulong getTailSize() const noexcept {return m_tail_size;}
+            void process(const sample* in1, sample* out1) noexcept;
+            void retire() noexcept;
+        };
+        
+        vector<sample>      m_response;
+        mutable mutex       m_mutex;
+        unique_ptr<Engine>  m_engine;
+        unique_ptr<Engine>  m_pending;
+        atomic_bool         m_ready;
+        mutex               m_swap;
+        atomic_ulong        m_misses;
+        
+        void post(unique_ptr<Engine> engine);
+    public:
+        DspConvolution(sDspChain chain, vector<sample> const& response = {}) noexcept;
+        ~DspConvolution();
+        string getName() const noexcept override;
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        void setResponse(vector<sample> const& response);
+        void getResponse(vector<sample>& response) const;
+        ulong getNumberOfMisses() const noexcept;
+    };
+}
+
+#endif
+
+
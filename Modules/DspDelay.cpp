@@ -0,0 +1,260 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspDelay.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      DELAY WRITE                                 //
+    // ================================================================================ //
+    
+    DspDelayWrite::DspDelayWrite(sDspChain chain, const ulong size) noexcept : DspNode(chain, 1, 0),
+    m_size(size),
+    m_mask(0),
+    m_head(0)
+    {
+        ;
+    }
+    
+    DspDelayWrite::~DspDelayWrite()
+    {
+        ;
+    }
+    
+    string DspDelayWrite::getName() const noexcept
+    {
+        return "DelayWrite";
+    }
+    
+    void DspDelayWrite::prepare() noexcept
+    {
+        // The buffer keeps the maximum delay, a vector and the points of the interpolation.
+        ulong size = 1;
+        while(size < m_size + getVectorSize() + 4)
+        {
+            size *= 2;
+        }
+        try
+        {
+            m_buffer.assign(size, 0.);
+            m_mask = size - 1;
+            m_head = 0;
+            shouldPerform(true);
+        }
+        catch(bad_alloc& e)
+        {
+            m_buffer.clear();
+            m_mask = 0;
+            shouldPerform(false);
+        }
+    }
+    
+    void DspDelayWrite::perform() noexcept
+    {
+        const ulong vectorsize = getVectorSize();
+        const ulong first = min(vectorsize, m_mask + 1 - m_head);
+        Signal::vcopy(first, getInputsSamples()[0], m_buffer.data() + m_head);
+        Signal::vcopy(vectorsize - first, getInputsSamples()[0] + first, m_buffer.data());
+        m_head = (m_head + vectorsize) & m_mask;
+    }
+    
+    void DspDelayWrite::release() noexcept
+    {
+        ;
+    }
+    
+    void DspDelayWrite::resize() noexcept
+    {
+        // The most recent samples are kept so the readers don't restart from silence.
+        vector<sample> buffer;
+        buffer.swap(m_buffer);
+        const ulong mask = m_mask;
+        const ulong head = m_head;
+        prepare();
+        if(!m_buffer.empty() && !buffer.empty())
+        {
+            const ulong count = min((ulong)buffer.size(), (ulong)m_buffer.size());
+            for(ulong i = 0; i < count; i++)
+            {
+                m_buffer[count - 1 - i] = buffer[(head - 1 - i) & mask];
+            }
+            m_head = count & m_mask;
+        }
+    }
+    
+    ulong DspDelayWrite::getMaximumDelay() const noexcept
+    {
+        return m_size;
+    }
+    
+    // ================================================================================ //
+    //                                      DELAY READ                                  //
+    // ================================================================================ //
+    
+    DspDelayRead::DspDelayRead(sDspChain chain, sDspDelayWrite writer, const sample delay, const Interpolation interpolation) noexcept : DspNode(chain, 1, 1),
+    m_writer(writer),
+    m_interpolation(interpolation),
+    m_delay(delay),
+    m_minimum(0.),
+    m_last(0.),
+    m_after(false),
+    m_connected(false)
+    {
+        ;
+    }
+    
+    DspDelayRead::~DspDelayRead()
+    {
+        ;
+    }
+    
+    string DspDelayRead::getName() const noexcept
+    {
+        return "DelayRead";
+    }
+    
+    void DspDelayRead::getPredecessors(vector<sDspNode>& nodes) const noexcept
+    {
+        if(m_writer)
+        {
+            nodes.push_back(m_writer);
+        }
+    }
+    
+    void DspDelayRead::prepare() noexcept
+    {
+        shouldPerform(isOutputConnected(0));
+        m_connected = isInputConnected(0);
+        
+        // If the reader is performed before the writer, the last vector isn't recorded yet.
+        // The cubic and the allpass interpolations need one more sample after the delay.
+        m_after   = m_writer && m_writer->getIndex() && m_writer->getIndex() < getIndex();
+        m_minimum = sample(m_after ? 0 : getVectorSize()) + sample(m_interpolation == Linear ? 0 : 1);
+        m_last    = 0.;
+    }
+    
+    inline sample DspDelayRead::read(const sample* buffer, const ulong mask, const ulong position, sample delay) noexcept
+    {
+        delay = max(min(delay, sample(m_writer->m_size)), m_minimum);
+        ulong n = ulong(delay);
+        sample frac = delay - sample(n);
+        switch(m_interpolation)
+        {
+            case Cubic:
+            {
+                const sample xm1 = buffer[(position - n + 1) & mask];
+                const sample x0  = buffer[(position - n) & mask];
+                const sample x1  = buffer[(position - n - 1) & mask];
+                const sample x2  = buffer[(position - n - 2) & mask];
+                const sample c1  = sample(0.5) * (x1 - xm1);
+                const sample c2  = xm1 - sample(2.5) * x0 + sample(2.) * x1 - sample(0.5) * x2;
+                const sample c3  = sample(0.5) * (x2 - xm1) + sample(1.5) * (x0 - x1);
+                return ((c3 * frac + c2) * frac + c1) * frac + x0;
+            }
+            case Allpass:
+            {
+                // The fraction is kept between 0.5 and 1.5 so the coefficient stays small.
+                if(frac < sample(0.5))
+                {
+                    n--;
+                    frac += sample(1.);
+                }
+                const sample eta = (sample(1.) - frac) / (sample(1.) + frac);
+                m_last = eta * buffer[(position - n) & mask] + buffer[(position - n - 1) & mask] - eta * m_last;
+                return m_last;
+            }
+            default:
+            {
+                const sample x0 = buffer[(position - n) & mask];
+                const sample x1 = buffer[(position - n - 1) & mask];
+                return x0 + frac * (x1 - x0);
+            }
+        }
+    }
+    
+    void DspDelayRead::perform() noexcept
+    {
+        const sample* in1 = getInputsSamples()[0];
+        sample* out1 = getOutputsSamples()[0];
+        const ulong vectorsize = getVectorSize();
+        if(!m_writer || !m_writer->isRunning())
+        {
+            Signal::vclear(vectorsize, out1);
+            return;
+        }
+        
+        const sample* buffer = m_writer->m_buffer.data();
+        const ulong mask = m_writer->m_mask;
+        const ulong start = m_after ? (m_writer->m_head - vectorsize) & mask : m_writer->m_head;
+        if(m_connected)
+        {
+            for(ulong i = 0; i < vectorsize; i++)
+            {
+                out1[i] = read(buffer, mask, start + i, in1[i]);
+            }
+        }
+        else
+        {
+            const sample delay = max(min(m_delay, sample(m_writer->m_size)), m_minimum);
+            if(m_interpolation == Linear && delay == sample(ulong(delay)))
+            {
+                const ulong position = (start - ulong(delay)) & mask;
+                const ulong first = min(vectorsize, mask + 1 - position);
+                Signal::vcopy(first, buffer + position, out1);
+                Signal::vcopy(vectorsize - first, buffer, out1 + first);
+            }
+            else
+            {
+                for(ulong i = 0; i < vectorsize; i++)
+                {
+                    out1[i] = read(buffer, mask, start + i, delay);
+                }
+            }
+        }
+    }
+    
+    void DspDelayRead::release() noexcept
+    {
+        ;
+    }
+    
+    void DspDelayRead::resize() noexcept
+    {
+        // The state of the allpass interpolation is kept.
+        const sample last = m_last;
+        prepare();
+        m_last = last;
+    }
+    
+    void DspDelayRead::setDelay(const sample delay) noexcept
+    {
+        m_delay = delay;
+    }
+    
+    sample DspDelayRead::getDelay() const noexcept
+    {
+        return m_delay;
+    }
+}
+
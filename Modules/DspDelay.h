@@ -0,0 +1,104 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_DELAY__
+#define __DEF_KIWI_DSP_DELAY__
+
+#include "../Context/DspDevice.h"
+
+namespace Kiwi
+{
+    class DspDelayWrite;
+    typedef shared_ptr<DspDelayWrite>   sDspDelayWrite;
+    
+    // ================================================================================ //
+    //                                      DELAY WRITE                                 //
+    // ================================================================================ //
+    
+    //! The delay write node records its input in a ring buffer.
+    /**
+     The delay write node records its input in a ring buffer with a power of two size so the positions are wrapped with a mask. The buffer is read by the delay read nodes of the same chain. The pair isn't linked so it can be used in a feedback loop, if the readers depend on the writer, they are performed before it and the delay is at least one vector.
+     */
+    class DspDelayWrite : public DspNode
+    {
+        friend class DspDelayRead;
+    private:
+        const ulong     m_size;
+        vector<sample>  m_buffer;
+        ulong           m_mask;
+        ulong           m_head;
+    public:
+        DspDelayWrite(sDspChain chain, const ulong size) noexcept;
+        ~DspDelayWrite();
+        string getName() const noexcept override;
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        void resize() noexcept override;
+        ulong getMaximumDelay() const noexcept;
+    };
+    
+    // ================================================================================ //
+    //                                      DELAY READ                                  //
+    // ================================================================================ //
+    
+    //! The delay read node reads the ring buffer of a delay write node.
+    /**
+     The delay read node reads the buffer of a delay write node with a fractional delay in samples given by its input signal if it's connected, otherwise by its value. The reads are interpolated linearly, with a cubic Hermite polynomial or with a first order allpass filter. A constant integer delay with the linear interpolation is a block copy.
+     */
+    class DspDelayRead : public DspNode
+    {
+    public:
+        enum Interpolation
+        {
+            Linear  = 0,
+            Cubic   = 1,
+            Allpass = 2
+        };
+    private:
+        const sDspDelayWrite    m_writer;
+        const Interpolation     m_interpolation;
+        sample                  m_delay;
+        sample                  m_minimum;
+        sample                  m_last;
+        bool                    m_after;
+        bool                    m_connected;
+        
+        inline sample read(const sample* buffer, const ulong mask, const ulong position, sample delay) noexcept;
+        void getPredecessors(vector<sDspNode>& nodes) const noexcept override;
+    public:
+        DspDelayRead(sDspChain chain, sDspDelayWrite writer, const sample delay = 0., const Interpolation interpolation = Linear) noexcept;
+        ~DspDelayRead();
+        string getName() const noexcept override;
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        void resize() noexcept override;
+        void setDelay(const sample delay) noexcept;
+        sample getDelay() const noexcept;
+    };
+}
+
+#endif
+
+
@@ -0,0 +1,209 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspFir.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      FIR                                         //
+    // ================================================================================ //
+    
+    template <class Type> static ulong filter(const ulong size, const ulong nchannels, const ulong start, const Type* coefficients, Type* history, const ulong vectorsize, const Type* in, Type* out) noexcept
+    {
+        ulong index = start;
+        for(ulong i = 0; i < nchannels; i++)
+        {
+            // Each sample is written at its index and one kernel later, the window
+            // of the last samples always starts just after the current index.
+            const Type* in1 = in + i * vectorsize;
+            Type* out1 = out + i * vectorsize;
+            Type* history1 = history + i * size * 2;
+            index = start;
+            for(ulong j = 0; j < vectorsize; j++)
+            {
+                history1[index] = history1[index + size] = in1[j];
+                out1[j] = Signal::vdot(size, coefficients, history1 + index + 1);
+                if(++index == size)
+                {
+                    index = 0;
+                }
+            }
+        }
+        return index;
+    }
+    
+    DspFir::Kernel::Kernel(vector<sample> const& coefficients, const ulong nchannels, const bool precision) :
+    m_size(max((ulong)coefficients.size(), 1ul)),
+    m_nchannels(nchannels),
+    m_index(0)
+    {
+        // The coefficients are reversed so the oldest sample of the history meets the last one.
+        if(precision)
+        {
+            m_dcoefficients.resize(m_size, 0.);
+            m_dhistory.resize(m_nchannels * m_size * 2, 0.);
+            for(ulong i = 0; i < (ulong)coefficients.size(); i++)
+            {
+                m_dcoefficients[m_size - 1 - i] = coefficients[i];
+            }
+        }
+        else
+        {
+            m_coefficients.resize(m_size, 0.);
+            m_history.resize(m_nchannels * m_size * 2, 0.);
+            for(ulong i = 0; i < (ulong)coefficients.size(); i++)
+            {
+                m_coefficients[m_size - 1 - i] = coefficients[i];
+            }
+        }
+    }
+    
+    void DspFir::Kernel::recall(Kernel const& other) noexcept
+    {
+        if(other.m_size == m_size && other.m_nchannels == m_nchannels && other.m_history.size() == m_history.size())
+        {
+            Signal::vcopy((ulong)m_history.size(), other.m_history.data(), m_history.data());
+            Signal::vcopy((ulong)m_dhistory.size(), other.m_dhistory.data(), m_dhistory.data());
+            m_index = other.m_index;
+        }
+    }
+    
+    void DspFir::Kernel::clear() noexcept
+    {
+        Signal::vclear((ulong)m_history.size(), m_history.data());
+        Signal::vclear((ulong)m_dhistory.size(), m_dhistory.data());
+        m_index = 0;
+    }
+    
+    void DspFir::Kernel::process(const ulong vectorsize, const sample* in, sample* out) noexcept
+    {
+        m_index = filter(m_size, m_nchannels, m_index, m_coefficients.data(), m_history.data(), vectorsize, in, out);
+    }
+    
+    void DspFir::Kernel::processDoubles(const ulong vectorsize, const double* in, double* out) noexcept
+    {
+        m_index = filter(m_size, m_nchannels, m_index, m_dcoefficients.data(), m_dhistory.data(), vectorsize, in, out);
+    }
+    
+    DspFir::DspFir(sDspChain chain, vector<sample> const& coefficients, const ulong nchannels, const bool precision) noexcept : DspNode(chain, 1, 1),
+    m_nchannels(max(nchannels, 1ul)),
+    m_coefficients(coefficients),
+    m_ready(false)
+    {
+        setNumberOfInputChannels(0, m_nchannels);
+        setNumberOfOutputChannels(0, m_nchannels);
+        setDoublePrecision(precision);
+    }
+    
+    DspFir::~DspFir()
+    {
+        ;
+    }
+    
+    string DspFir::getName() const noexcept
+    {
+        return "Fir";
+    }
+    
+    void DspFir::post(unique_ptr<Kernel> kernel)
+    {
+        // The previous pending kernel or the kernel released by the audio thread is freed here.
+        lock_guard<mutex> guard(m_swap);
+        m_pending = move(kernel);
+        m_ready   = true;
+    }
+    
+    void DspFir::prepare() noexcept
+    {
+        shouldPerform(isOutputConnected(0));
+        lock_guard<mutex> guard(m_mutex);
+        {
+            lock_guard<mutex> swap(m_swap);
+            if(m_ready)
+            {
+                m_kernel.swap(m_pending);
+                m_ready = false;
+            }
+        }
+        if(!m_kernel)
+        {
+            try
+            {
+                m_kernel = unique_ptr<Kernel>(new Kernel(m_coefficients, m_nchannels, isDoublePrecision()));
+            }
+            catch(bad_alloc& e)
+            {
+                shouldPerform(false);
+                return;
+            }
+        }
+        m_kernel->clear();
+    }
+    
+    void DspFir::perform() noexcept
+    {
+        if(m_ready && m_swap.try_lock())
+        {
+            if(m_ready)
+            {
+                m_pending->recall(*m_kernel);
+                m_kernel.swap(m_pending);
+                m_ready = false;
+            }
+            m_swap.unlock();
+        }
+        if(isDoublePrecision())
+        {
+            m_kernel->processDoubles(getVectorSize(), getInputsDoubles()[0], getOutputsDoubles()[0]);
+        }
+        else
+        {
+            m_kernel->process(getVectorSize(), getInputsSamples()[0], getOutputsSamples()[0]);
+        }
+    }
+    
+    void DspFir::release() noexcept
+    {
+        ;
+    }
+    
+    void DspFir::setCoefficients(vector<sample> const& coefficients)
+    {
+        lock_guard<mutex> guard(m_mutex);
+        m_coefficients = coefficients;
+        post(unique_ptr<Kernel>(new Kernel(m_coefficients, m_nchannels, isDoublePrecision())));
+    }
+    
+    void DspFir::getCoefficients(vector<sample>& coefficients) const
+    {
+        lock_guard<mutex> guard(m_mutex);
+        coefficients = m_coefficients;
+    }
+    
+    ulong DspFir::getNumberOfChannels() const noexcept
+    {
+        return m_nchannels;
+    }
+}
+
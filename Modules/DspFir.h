@@ -0,0 +1,85 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_FIR__
+#define __DEF_KIWI_DSP_FIR__
+
+#include "../Context/DspDevice.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      FIR                                         //
+    // ================================================================================ //
+    
+    //! The fir node performs a direct form finite impulse response filter.
+    /**
+     The fir node filters each channel of its input with the same short kernel, from 16 to 512 coefficients, for which a convolution in the frequency domain would be too expensive. The history of each channel is stored twice in a buffer of twice the size of the kernel so the last samples are always contiguous and each output sample is a single dot product. The new kernels are allocated by the thread that sets the coefficients and handed to the audio thread without lock. The node can filter in double precision so the long kernels don't accumulate the rounding errors of the single precision, the signals are then converted by its links.
+     */
+    class DspFir : public DspNode
+    {
+    private:
+        class Kernel
+        {
+        private:
+            const ulong     m_size;
+            const ulong     m_nchannels;
+            vector<sample>  m_coefficients;
+            vector<sample>  m_history;
+            vector<double>  m_dcoefficients;
+            vector<double>  m_dhistory;
+            ulong           m_index;
+        public:
+            Kernel(vector<sample> const& coefficients, const ulong nchannels, const bool precision);
+            inline ulong getSize() const noexcept {return m_size;}
+            void recall(Kernel const& other) noexcept;
+            void clear() noexcept;
+            void process(const ulong vectorsize, const sample* in, sample* out) noexcept;
+            void processDoubles(const ulong vectorsize, const double* in, double* out) noexcept;
+        };
+        
+        const ulong         m_nchannels;
+        vector<sample>      m_coefficients;
+        mutable mutex       m_mutex;
+        unique_ptr<Kernel>  m_kernel;
+        unique_ptr<Kernel>  m_pending;
+        atomic_bool         m_ready;
+        mutex               m_swap;
+        
+        void post(unique_ptr<Kernel> kernel);
+    public:
+        DspFir(sDspChain chain, vector<sample> const& coefficients = {}, const ulong nchannels = 1, const bool precision = false) noexcept;
+        ~DspFir();
+        string getName() const noexcept override;
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        void setCoefficients(vector<sample> const& coefficients);
+        void getCoefficients(vector<sample>& coefficients) const;
+        ulong getNumberOfChannels() const noexcept;
+    };
+}
+
+#endif
+
+
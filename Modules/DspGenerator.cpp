@@ -29,7 +29,7 @@ namespace Kiwi
     //                                      SIG                                         //
     // ================================================================================ //
     
-    DspSig::DspSig(sDspChain chain, const sample value) noexcept : DspNode(chain, 0, 1), m_value(value)
+    DspSig::DspSig(sDspChain chain, const sample value) noexcept : DspNode(chain, 0, 1), m_value(value), m_last(value)
     {
         ;
     }
@@ -47,11 +47,19 @@ namespace Kiwi
     void DspSig::prepare() noexcept
     {
         shouldPerform(isOutputConnected(0));
+        m_value.prepare(getSampleRate());
     }
     
     void DspSig::perform() noexcept
     {
-        Signal::vfill(getVectorSize(), m_value, getOutputsSamples()[0]);
+        if(m_value.isConstant())
+        {
+            Signal::vfill(getVectorSize(), m_value.getValue(), getOutputsSamples()[0]);
+        }
+        else
+        {
+            m_value.perform(getVectorSize(), getOutputsSamples()[0]);
+        }
     }
     
     void DspSig::release() noexcept
@@ -59,14 +67,20 @@ namespace Kiwi
         ;
     }
     
-    void DspSig::setValue(const sample value) noexcept
+    void DspSig::setValue(const sample value, const ulong time) noexcept
     {
-        m_value = value;
+        m_last = value;
+        post(m_value, value, time);
     }
     
     sample DspSig::getValue() const noexcept
     {
-        return m_value;
+        return m_last;
+    }
+    
+    void DspSig::setSmoothing(const DspParameter::Smoothing smoothing, const double time) noexcept
+    {
+        m_value.setSmoothing(smoothing, time);
     }
     
     // ================================================================================ //
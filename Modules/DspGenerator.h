@@ -35,7 +35,8 @@ namespace Kiwi
     class DspSig : public DspNode
     {
     private:
-        sample m_value;
+        DspParameter    m_value;
+        sample          m_last;
     public:
         DspSig(sDspChain chain, const sample value = 0.) noexcept;
         ~DspSig();
@@ -43,8 +44,9 @@ namespace Kiwi
         void prepare() noexcept override;
         void perform() noexcept override;
         void release() noexcept override;
-        void setValue(const sample value) noexcept;
+        void setValue(const sample value, const ulong time = 0) noexcept;
         sample getValue() const noexcept;
+        void setSmoothing(const DspParameter::Smoothing smoothing, const double time) noexcept;
     };
     
     // ================================================================================ //
@@ -30,14 +30,19 @@ namespace Kiwi
     // ================================================================================ //
     
     DspDac::DspDac(sDspChain chain, vector<ulong> const& channels) noexcept :
-    DspNode(chain, channels.size(), 0)
+    DspNode(chain, 1, 0),
+    m_device(nullptr),
+    m_bridge(nullptr)
     {
         m_channels = channels;
+        setNumberOfInputChannels(0, m_channels.size());
     }
     
     DspDac::~DspDac()
     {
+        m_pointers.clear();
         m_outputs.clear();
+        m_indices.clear();
     }
     
     string DspDac::getName() const noexcept
@@ -49,37 +54,66 @@ namespace Kiwi
     {
         shouldPerform(false);
         m_outputs.clear();
+        m_indices.clear();
+        m_pointers.assign(m_channels.size(), nullptr);
         scDspDeviceManager device = getDeviceManager();
-        sDspContext contxt = getContext();
+        sDspChain chain = getChain();
+        m_device = device.get();
+        m_bridge = (chain && chain->isBridged()) ? chain.get() : nullptr;
 
-        if(device && !m_channels.empty())
+        if(m_device && !m_channels.empty())
         {
             for(vector<ulong>::size_type i = 0; i < m_channels.size(); i++)
             {
-                if(m_channels[i] <= device->getNumberOfOutputs())
+                // If the chain is bridged, the node writes the outputs of the bridge.
+                // If the device doesn't bind its outputs, the pointers don't change.
+                sample* const* out = nullptr;
+                if(m_channels[i] && m_channels[i] <= m_device->getNumberOfOutputs())
                 {
-                    sample* out = device->getOutputsSamples(m_channels[i] - 1);
-                    if(out)
+                    out = m_bridge ? m_bridge->getOutputsBinding(m_channels[i] - 1) : m_device->getOutputsBinding(m_channels[i] - 1);
+                    if(!out && !m_bridge)
                     {
-                        m_outputs.push_back(device->getOutputsSamples(m_channels[i] - 1));
-                        shouldPerform(true);
+                        m_pointers[i] = m_device->getOutputsSamples(m_channels[i] - 1);
+                        out = m_pointers[i] ? &m_pointers[i] : nullptr;
                     }
                 }
+                m_outputs.push_back(out);
+                m_indices.push_back(m_channels[i] - 1);
+                if(out)
+                {
+                    shouldPerform(true);
+                }
             }
         }
     }
     
     void DspDac::perform() noexcept
     {
-        for(vector<float*>::size_type i = 0; i < m_outputs.size(); i++)
+        // The first node that writes a channel during the cycle copies, the others add.
+        for(vector<sample* const*>::size_type i = 0; i < m_outputs.size(); i++)
         {
-            Signal::vadd(getVectorSize(), getInputsSamples()[i], m_outputs[i]);
+            sample* out = m_outputs[i] ? *m_outputs[i] : nullptr;
+            if(out)
+            {
+                if(m_bridge ? m_bridge->claimOutput(m_indices[i]) : m_device->claimOutput(m_indices[i]))
+                {
+                    Signal::vcopy(getVectorSize(), getInputSamples(0, i), out);
+                }
+                else
+                {
+                    Signal::vadd(getVectorSize(), getInputSamples(0, i), out);
+                }
+            }
         }
     }
     
     void DspDac::release() noexcept
     {
+        m_pointers.clear();
         m_outputs.clear();
+        m_indices.clear();
+        m_device = nullptr;
+        m_bridge = nullptr;
     }
     
     void DspDac::setChannels(vector<ulong> const& channels) noexcept
@@ -94,5 +128,83 @@ namespace Kiwi
     {
         channels = m_channels;
     }
+    
+    // ================================================================================ //
+    //                                      ADC                                         //
+    // ================================================================================ //
+    
+    DspAdc::DspAdc(sDspChain chain, vector<ulong> const& channels) noexcept :
+    DspNode(chain, 0, channels.size()),
+    m_channels(channels),
+    m_pointers(channels.size(), nullptr)
+    {
+        ;
+    }
+    
+    DspAdc::~DspAdc()
+    {
+        ;
+    }
+    
+    string DspAdc::getName() const noexcept
+    {
+        return "Adc";
+    }
+    
+    void DspAdc::prepare() noexcept
+    {
+        shouldPerform(false);
+        scDspDeviceManager device = getDeviceManager();
+        sDspChain chain = getChain();
+        for(vector<ulong>::size_type i = 0; i < m_channels.size(); i++)
+        {
+            // If the chain is bridged, the node reads the inputs of the bridge, otherwise the
+            // buffers of the device can only be used if they have the size of the vectors.
+            // If the device doesn't bind its inputs, the pointers don't change.
+            const sample* const* in = nullptr;
+            m_pointers[i] = nullptr;
+            if(chain && chain->isBridged())
+            {
+                in = m_channels[i] ? chain->getInputsBinding(m_channels[i] - 1) : nullptr;
+            }
+            else if(device && device->getBlockSize() == getVectorSize() && m_channels[i] && m_channels[i] <= device->getNumberOfInputs())
+            {
+                in = device->getInputsBinding(m_channels[i] - 1);
+                if(!in)
+                {
+                    m_pointers[i] = device->getInputsSamples(m_channels[i] - 1);
+                    in = m_pointers[i] ? &m_pointers[i] : nullptr;
+                }
+            }
+            setOutputBinding(i, in);
+            if(isOutputConnected(i))
+            {
+                shouldPerform(true);
+            }
+        }
+    }
+    
+    void DspAdc::perform() noexcept
+    {
+        ;
+    }
+    
+    void DspAdc::release() noexcept
+    {
+        ;
+    }
+    
+    void DspAdc::setChannels(vector<ulong> const& channels) noexcept
+    {
+        for(vector<ulong>::size_type i = 0; i < m_channels.size() && i < channels.size(); i++)
+        {
+            m_channels[i] = channels[i];
+        }
+    }
+    
+    void DspAdc::getChannels(vector<ulong>& channels) const noexcept
+    {
+        channels = m_channels;
+    }
 }
 
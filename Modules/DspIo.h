@@ -35,8 +35,12 @@ namespace Kiwi
     class DspDac : public DspNode
     {
     private:
-        vector<ulong>    m_channels;
-        vector<sample*>  m_outputs;
+        vector<ulong>       m_channels;
+        vector<sample*>     m_pointers;
+        vector<sample* const*> m_outputs;
+        vector<ulong>       m_indices;
+        const DspDeviceManager* m_device;
+        const DspChain*     m_bridge;
     public:
         DspDac(sDspChain chain, vector<ulong> const& channels = {}) noexcept;
         ~DspDac();
@@ -48,6 +52,30 @@ namespace Kiwi
         void getChannels(vector<ulong>& channels) const noexcept;
     };
     
+    // ================================================================================ //
+    //                                      ADC                                         //
+    // ================================================================================ //
+    
+    //! The adc node retrieves the inputs of the device.
+    /**
+     The adc node has one output per channel of its mapping, the channels of the device start at 1 and 0 is a silent output. The outputs are bound to the input buffers of the device so the node doesn't copy anything, the linked nodes read the buffers, even if the device changes them at each cycle.
+     */
+    class DspAdc : public DspNode
+    {
+    private:
+        vector<ulong>           m_channels;
+        vector<const sample*>   m_pointers;
+    public:
+        DspAdc(sDspChain chain, vector<ulong> const& channels = {}) noexcept;
+        ~DspAdc();
+        string getName() const noexcept override;
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        void setChannels(vector<ulong> const& channels) noexcept;
+        void getChannels(vector<ulong>& channels) const noexcept;
+    };
+    
 }
 
 #endif
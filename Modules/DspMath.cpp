@@ -30,7 +30,8 @@ namespace Kiwi
     // ================================================================================ //
     
     DspPlus<DspScalar>::DspPlus(sDspChain chain, const sample value) noexcept : DspNode(chain, 1, 1),
-    m_value(value)
+    m_value(value),
+    m_last(value)
     {
         ;
     }
@@ -48,11 +49,28 @@ namespace Kiwi
     void DspPlus<DspScalar>::prepare() noexcept
     {
         shouldPerform(isOutputConnected(0));
+        m_value.prepare(getSampleRate());
+        try
+        {
+            m_buffer.resize(getVectorSize());
+        }
+        catch(bad_alloc& e)
+        {
+            shouldPerform(false);
+        }
     }
     
     void DspPlus<DspScalar>::perform() noexcept
     {
-        Signal::vsadd(getVectorSize(), m_value, getOutputsSamples()[0]);
+        if(m_value.isConstant())
+        {
+            Signal::vsadd(getVectorSize(), m_value.getValue(), getOutputsSamples()[0]);
+        }
+        else
+        {
+            m_value.perform(getVectorSize(), m_buffer.data());
+            Signal::vadd(getVectorSize(), m_buffer.data(), getOutputsSamples()[0]);
+        }
     }
     
     void DspPlus<DspScalar>::release() noexcept
@@ -60,14 +78,20 @@ namespace Kiwi
         ;
     }
     
-    void DspPlus<DspScalar>::setValue(const sample value) noexcept
+    void DspPlus<DspScalar>::setValue(const sample value, const ulong time) noexcept
     {
-        m_value = value;
+        m_last = value;
+        post(m_value, value, time);
     }
     
     sample DspPlus<DspScalar>::getValue() const noexcept
     {
-        return m_value;
+        return m_last;
+    }
+    
+    void DspPlus<DspScalar>::setSmoothing(const DspParameter::Smoothing smoothing, const double time) noexcept
+    {
+        m_value.setSmoothing(smoothing, time);
     }
     
     DspPlus<DspVector>::DspPlus(sDspChain chain) noexcept : DspNode(chain, 2, 1)
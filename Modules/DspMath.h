@@ -37,7 +37,9 @@ namespace Kiwi
     template <>class DspPlus<DspScalar> : public DspNode
     {
     private:
-        sample m_value;
+        DspParameter    m_value;
+        sample          m_last;
+        vector<sample>  m_buffer;
     public:
         DspPlus(sDspChain chain, const sample value = 0.) noexcept;
         ~DspPlus();
@@ -45,8 +47,9 @@ namespace Kiwi
         void prepare() noexcept override;
         void perform() noexcept override;
         void release() noexcept override;
-        void setValue(const sample value) noexcept;
+        void setValue(const sample value, const ulong time = 0) noexcept;
         sample getValue() const noexcept;
+        void setSmoothing(const DspParameter::Smoothing smoothing, const double time) noexcept;
     };
     
     template <>class DspPlus<DspVector> : public DspNode
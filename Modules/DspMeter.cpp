@@ -0,0 +1,175 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspMeter.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      METER                                       //
+    // ================================================================================ //
+    
+    DspMeter::DspMeter(sDspChain chain, const ulong period, const ulong size) noexcept : DspNode(chain, 1, 0),
+    m_period(max(period, 1ul)),
+    m_count(0),
+    m_feedback(size),
+    m_last(0.)
+    {
+        ;
+    }
+    
+    DspMeter::~DspMeter()
+    {
+        ;
+    }
+    
+    void DspMeter::prepare() noexcept
+    {
+        shouldPerform(isInputConnected(0));
+        m_count = 0;
+        reset();
+    }
+    
+    void DspMeter::perform() noexcept
+    {
+        // The vector is split at the ends of the periods so a period can be shorter or longer than a vector.
+        const ulong vectorsize = getVectorSize();
+        const sample* in1 = getInputsSamples()[0];
+        ulong index = 0;
+        while(index < vectorsize)
+        {
+            const ulong size = min(vectorsize - index, m_period - m_count);
+            measure(size, in1 + index);
+            index   += size;
+            m_count += size;
+            if(m_count == m_period)
+            {
+                m_feedback.push(getMeasure());
+                m_count = 0;
+                reset();
+            }
+        }
+    }
+    
+    void DspMeter::release() noexcept
+    {
+        ;
+    }
+    
+    ulong DspMeter::getPeriod() const noexcept
+    {
+        return m_period;
+    }
+    
+    DspFeedback<sample>& DspMeter::getFeedback() noexcept
+    {
+        return m_feedback;
+    }
+    
+    sample DspMeter::getValue() noexcept
+    {
+        m_feedback.getLatest(m_last);
+        return m_last;
+    }
+    
+    // ================================================================================ //
+    //                                      PEAK                                        //
+    // ================================================================================ //
+    
+    DspPeak::DspPeak(sDspChain chain, const ulong period, const ulong size) noexcept : DspMeter(chain, period, size),
+    m_peak(0.)
+    {
+        ;
+    }
+    
+    DspPeak::~DspPeak()
+    {
+        ;
+    }
+    
+    string DspPeak::getName() const noexcept
+    {
+        return "Peak";
+    }
+    
+    void DspPeak::reset() noexcept
+    {
+        m_peak = 0.;
+    }
+    
+    void DspPeak::measure(const ulong size, const sample* in1) noexcept
+    {
+        sample peak = m_peak;
+        for(ulong i = 0; i < size; i++)
+        {
+            peak = max(peak, sample(fabs(in1[i])));
+        }
+        m_peak = peak;
+    }
+    
+    sample DspPeak::getMeasure() const noexcept
+    {
+        return m_peak;
+    }
+    
+    // ================================================================================ //
+    //                                      RMS                                         //
+    // ================================================================================ //
+    
+    DspRms::DspRms(sDspChain chain, const ulong period, const ulong size) noexcept : DspMeter(chain, period, size),
+    m_sum(0.)
+    {
+        ;
+    }
+    
+    DspRms::~DspRms()
+    {
+        ;
+    }
+    
+    string DspRms::getName() const noexcept
+    {
+        return "Rms";
+    }
+    
+    void DspRms::reset() noexcept
+    {
+        m_sum = 0.;
+    }
+    
+    void DspRms::measure(const ulong size, const sample* in1) noexcept
+    {
+        double sum = m_sum;
+        for(ulong i = 0; i < size; i++)
+        {
+            sum += double(in1[i]) * double(in1[i]);
+        }
+        m_sum = sum;
+    }
+    
+    sample DspRms::getMeasure() const noexcept
+    {
+        return sample(sqrt(m_sum / double(getPeriod())));
+    }
+}
+
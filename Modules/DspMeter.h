@@ -0,0 +1,101 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+
+#ifndef __DEF_KIWI_DSP_METER__
+#define __DEF_KIWI_DSP_METER__
+
+#include "../Context/DspDevice.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      METER                                       //
+    // ================================================================================ //
+    
+    //! The meter node is the base of the nodes that measure their input for a control thread.
+    /**
+     The meter node measures its input over periods of samples and pushes one value per period in a dsp feedback. The control thread polls the latest value or the stream of values, the audio thread never waits and the values that the control thread doesn't retrieve in time are counted as overflows.
+     */
+    class DspMeter : public DspNode
+    {
+    private:
+        const ulong         m_period;
+        ulong               m_count;
+        DspFeedback<sample> m_feedback;
+        sample              m_last;
+    protected:
+        virtual void reset() noexcept = 0;
+        virtual void measure(const ulong size, const sample* in1) noexcept = 0;
+        virtual sample getMeasure() const noexcept = 0;
+    public:
+        DspMeter(sDspChain chain, const ulong period, const ulong size) noexcept;
+        virtual ~DspMeter();
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        ulong getPeriod() const noexcept;
+        DspFeedback<sample>& getFeedback() noexcept;
+        sample getValue() noexcept;
+    };
+    
+    // ================================================================================ //
+    //                                      PEAK                                        //
+    // ================================================================================ //
+    
+    //! The peak node measures the maximum absolute value of its input.
+    class DspPeak : public DspMeter
+    {
+    private:
+        sample m_peak;
+        void reset() noexcept override;
+        void measure(const ulong size, const sample* in1) noexcept override;
+        sample getMeasure() const noexcept override;
+    public:
+        DspPeak(sDspChain chain, const ulong period = 1024, const ulong size = 256) noexcept;
+        ~DspPeak();
+        string getName() const noexcept override;
+    };
+    
+    // ================================================================================ //
+    //                                      RMS                                         //
+    // ================================================================================ //
+    
+    //! The rms node measures the root mean square of its input.
+    class DspRms : public DspMeter
+    {
+    private:
+        double m_sum;
+        void reset() noexcept override;
+        void measure(const ulong size, const sample* in1) noexcept override;
+        sample getMeasure() const noexcept override;
+    public:
+        DspRms(sDspChain chain, const ulong period = 1024, const ulong size = 256) noexcept;
+        ~DspRms();
+        string getName() const noexcept override;
+    };
+}
+
+#endif
+
+
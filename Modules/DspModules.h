@@ -27,5 +27,10 @@
 #include "DspIo.h"
 #include "DspGenerator.h"
 #include "DspMath.h"
+#include "DspConvolution.h"
+#include "DspFir.h"
+#include "DspDelay.h"
+#include "DspPoly.h"
+#include "DspMeter.h"
 
 #endif
@@ -0,0 +1,314 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspPoly.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      POLY                                        //
+    // ================================================================================ //
+    
+    const ulong DspPoly::c_lanes;
+    
+    DspPoly::DspPoly(sDspChain chain, const ulong nvoices) noexcept : DspNode(chain, 0, 1),
+    m_nvoices(((max(nvoices, 1ul) + c_lanes - 1) / c_lanes) * c_lanes),
+    m_events(256),
+    m_head(0),
+    m_tail(0),
+    m_keys(m_nvoices, 0),
+    m_ages(m_nvoices, 0),
+    m_active(m_nvoices, 0),
+    m_held(m_nvoices, 0),
+    m_groups(m_nvoices / c_lanes, 0),
+    m_age(0),
+    m_nactives(0)
+    {
+        ;
+    }
+    
+    DspPoly::~DspPoly()
+    {
+        ;
+    }
+    
+    bool DspPoly::post(Event const& event) noexcept
+    {
+        const ulong tail = m_tail.load(memory_order_relaxed);
+        if(tail - m_head.load(memory_order_acquire) >= (ulong)m_events.size())
+        {
+            return false;
+        }
+        m_events[tail & (m_events.size() - 1)] = event;
+        m_tail.store(tail + 1, memory_order_release);
+        return true;
+    }
+    
+    bool DspPoly::noteOn(const ulong key, const sample velocity) noexcept
+    {
+        return post({true, key, velocity});
+    }
+    
+    bool DspPoly::noteOff(const ulong key) noexcept
+    {
+        return post({false, key, 0.});
+    }
+    
+    void DspPoly::dispatch(Event const& event) noexcept
+    {
+        if(event.on)
+        {
+            // The first free voice is used so the active voices stay in the first groups,
+            // if there is no free voice, the oldest one is stolen.
+            ulong voice = m_nvoices;
+            for(ulong i = 0; i < m_nvoices && voice == m_nvoices; i++)
+            {
+                if(!m_active[i])
+                {
+                    voice = i;
+                }
+            }
+            if(voice == m_nvoices)
+            {
+                voice = 0;
+                for(ulong i = 1; i < m_nvoices; i++)
+                {
+                    if(m_ages[i] < m_ages[voice])
+                    {
+                        voice = i;
+                    }
+                }
+            }
+            else
+            {
+                m_active[voice] = 1;
+                m_groups[voice / c_lanes]++;
+                m_nactives++;
+            }
+            m_keys[voice] = event.key;
+            m_ages[voice] = ++m_age;
+            m_held[voice] = 1;
+            startVoice(voice, event.key, event.velocity);
+        }
+        else
+        {
+            for(ulong i = 0; i < m_nvoices; i++)
+            {
+                if(m_held[i] && m_keys[i] == event.key)
+                {
+                    m_held[i] = 0;
+                    stopVoice(i);
+                    break;
+                }
+            }
+        }
+    }
+    
+    void DspPoly::freeVoice(const ulong voice) noexcept
+    {
+        if(voice < m_nvoices && m_active[voice])
+        {
+            m_active[voice] = 0;
+            m_held[voice]   = 0;
+            m_groups[voice / c_lanes]--;
+            m_nactives--;
+        }
+    }
+    
+    void DspPoly::prepare() noexcept
+    {
+        shouldPerform(isOutputConnected(0));
+        try
+        {
+            m_buffer.assign(getVectorSize() * c_lanes, 0.);
+        }
+        catch(bad_alloc& e)
+        {
+            shouldPerform(false);
+        }
+        for(ulong i = 0; i < m_nvoices; i++)
+        {
+            m_active[i] = 0;
+            m_held[i]   = 0;
+        }
+        for(ulong i = 0; i < m_nvoices / c_lanes; i++)
+        {
+            m_groups[i] = 0;
+        }
+        m_nactives = 0;
+        prepareVoices();
+    }
+    
+    void DspPoly::perform() noexcept
+    {
+        const ulong tail = m_tail.load(memory_order_acquire);
+        ulong head = m_head.load(memory_order_relaxed);
+        while(head != tail)
+        {
+            dispatch(m_events[head & (m_events.size() - 1)]);
+            head++;
+        }
+        m_head.store(head, memory_order_release);
+        
+        const ulong vectorsize = getVectorSize();
+        sample* out1 = getOutputsSamples()[0];
+        sample* buffer = m_buffer.data();
+        Signal::vclear(vectorsize, out1);
+        for(ulong i = 0; i < m_nvoices / c_lanes; i++)
+        {
+            if(m_groups[i])
+            {
+                // The voices are computed sample by sample in the lanes then mixed.
+                performVoices(i * c_lanes, buffer);
+                for(ulong j = 0; j < vectorsize; j++)
+                {
+                    sample sum = 0.;
+                    for(ulong k = 0; k < c_lanes; k++)
+                    {
+                        sum += buffer[j * c_lanes + k];
+                    }
+                    out1[j] += sum;
+                }
+            }
+        }
+    }
+    
+    void DspPoly::release() noexcept
+    {
+        ;
+    }
+    
+    ulong DspPoly::getNumberOfVoices() const noexcept
+    {
+        return m_nvoices;
+    }
+    
+    ulong DspPoly::getNumberOfActiveVoices() const noexcept
+    {
+        return m_nactives;
+    }
+    
+    // ================================================================================ //
+    //                                      POLY SINE                                   //
+    // ================================================================================ //
+    
+    DspPolySine::DspPolySine(sDspChain chain, const ulong nvoices, const sample attack, const sample release) noexcept : DspPoly(chain, nvoices),
+    m_attack(max(attack, sample(0.))),
+    m_release(max(release, sample(0.))),
+    m_real(getNumberOfVoices(), 0.),
+    m_imag(getNumberOfVoices(), 0.),
+    m_cos(getNumberOfVoices(), 1.),
+    m_sin(getNumberOfVoices(), 0.),
+    m_level(getNumberOfVoices(), 0.),
+    m_slope(getNumberOfVoices(), 0.),
+    m_gain(getNumberOfVoices(), 0.)
+    {
+        ;
+    }
+    
+    DspPolySine::~DspPolySine()
+    {
+        ;
+    }
+    
+    string DspPolySine::getName() const noexcept
+    {
+        return "PolySine";
+    }
+    
+    void DspPolySine::prepareVoices() noexcept
+    {
+        const ulong nvoices = getNumberOfVoices();
+        Signal::vclear(nvoices, m_real.data());
+        Signal::vclear(nvoices, m_imag.data());
+        Signal::vclear(nvoices, m_level.data());
+        Signal::vclear(nvoices, m_slope.data());
+        Signal::vclear(nvoices, m_gain.data());
+    }
+    
+    void DspPolySine::startVoice(const ulong voice, const ulong key, const sample velocity) noexcept
+    {
+        const double pi = 3.14159265358979323846;
+        const double frequency = 440. * pow(2., (double(key) - 69.) / 12.);
+        const double step = 2. * pi * frequency / double(max(getSampleRate(), 1ul));
+        m_cos[voice] = sample(cos(step));
+        m_sin[voice] = sample(sin(step));
+        if(m_level[voice] <= 0.)
+        {
+            m_real[voice] = 1.;
+            m_imag[voice] = 0.;
+        }
+        const sample length = m_attack * sample(getSampleRate()) / sample(1000.);
+        m_slope[voice] = length > sample(1.) ? sample(1.) / length : sample(1.);
+        m_gain[voice]  = velocity;
+    }
+    
+    void DspPolySine::stopVoice(const ulong voice) noexcept
+    {
+        const sample length = m_release * sample(getSampleRate()) / sample(1000.);
+        m_slope[voice] = length > sample(1.) ? sample(-1.) / length : sample(-1.);
+    }
+    
+    void DspPolySine::performVoices(const ulong first, sample* out) noexcept
+    {
+        sample* real        = m_real.data() + first;
+        sample* imag        = m_imag.data() + first;
+        sample* level       = m_level.data() + first;
+        const sample* cosw  = m_cos.data() + first;
+        const sample* sinw  = m_sin.data() + first;
+        const sample* slope = m_slope.data() + first;
+        const sample* gain  = m_gain.data() + first;
+        const ulong vectorsize = getVectorSize();
+        for(ulong i = 0; i < vectorsize; i++)
+        {
+            sample* out1 = out + i * c_lanes;
+            for(ulong j = 0; j < c_lanes; j++)
+            {
+                const sample re = real[j] * cosw[j] - imag[j] * sinw[j];
+                const sample im = real[j] * sinw[j] + imag[j] * cosw[j];
+                const sample lv = min(max(level[j] + slope[j], sample(0.)), sample(1.));
+                real[j]  = re;
+                imag[j]  = im;
+                level[j] = lv;
+                out1[j]  = im * lv * gain[j];
+            }
+        }
+        
+        // The rotations are normalized once per vector and the released voices are freed.
+        for(ulong j = 0; j < c_lanes; j++)
+        {
+            const sample norm = sqrt(real[j] * real[j] + imag[j] * imag[j]);
+            if(norm > 0.)
+            {
+                real[j] /= norm;
+                imag[j] /= norm;
+            }
+            if(slope[j] < 0. && level[j] <= 0.)
+            {
+                m_slope[first + j] = 0.;
+                freeVoice(first + j);
+            }
+        }
+    }
+}
+
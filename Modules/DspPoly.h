@@ -0,0 +1,118 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_POLY__
+#define __DEF_KIWI_DSP_POLY__
+
+#include "../Context/DspDevice.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      POLY                                        //
+    // ================================================================================ //
+    
+    //! The poly node is the base of the nodes that process several voices at once.
+    /**
+     The poly node manages a fixed number of voices that a subclass processes in groups of lanes. The subclasses store the states of the voices in structures of arrays indexed by voice so a kernel runs the voices of a group in the lanes of the vector registers. The groups without active voice are skipped and the voices are allocated from the first groups. The notes are posted by one control thread in a lock-free queue and the voices are allocated by the audio thread at the beginning of each vector, when all the voices are active, the oldest one is stolen.
+     */
+    class DspPoly : public DspNode
+    {
+    public:
+        static const ulong c_lanes = 8;
+    private:
+        struct Event
+        {
+            bool    on;
+            ulong   key;
+            sample  velocity;
+        };
+        
+        const ulong     m_nvoices;
+        vector<Event>   m_events;
+        atomic_ulong    m_head;
+        atomic_ulong    m_tail;
+        vector<ulong>   m_keys;
+        vector<ulong>   m_ages;
+        vector<char>    m_active;
+        vector<char>    m_held;
+        vector<ulong>   m_groups;
+        vector<sample>  m_buffer;
+        ulong           m_age;
+        atomic_ulong    m_nactives;
+        
+        void dispatch(Event const& event) noexcept;
+        bool post(Event const& event) noexcept;
+    public:
+        DspPoly(sDspChain chain, const ulong nvoices) noexcept;
+        virtual ~DspPoly();
+        void prepare() noexcept override;
+        void perform() noexcept override;
+        void release() noexcept override;
+        bool noteOn(const ulong key, const sample velocity) noexcept;
+        bool noteOff(const ulong key) noexcept;
+        ulong getNumberOfVoices() const noexcept;
+        ulong getNumberOfActiveVoices() const noexcept;
+    protected:
+        void freeVoice(const ulong voice) noexcept;
+        virtual void prepareVoices() noexcept { ; }
+        virtual void startVoice(const ulong voice, const ulong key, const sample velocity) noexcept = 0;
+        virtual void stopVoice(const ulong voice) noexcept = 0;
+        virtual void performVoices(const ulong first, sample* out) noexcept = 0;
+    };
+    
+    // ================================================================================ //
+    //                                      POLY SINE                                   //
+    // ================================================================================ //
+    
+    //! The poly sine node is a polyphonic sine oscillator with a linear envelope.
+    /**
+     The poly sine node plays a sine for each note with a linear attack and release. The oscillators are complex rotations so the voices of a group are computed in the lanes of the vector registers.
+     */
+    class DspPolySine : public DspPoly
+    {
+    private:
+        const sample    m_attack;
+        const sample    m_release;
+        vector<sample>  m_real;
+        vector<sample>  m_imag;
+        vector<sample>  m_cos;
+        vector<sample>  m_sin;
+        vector<sample>  m_level;
+        vector<sample>  m_slope;
+        vector<sample>  m_gain;
+        
+        void prepareVoices() noexcept override;
+        void startVoice(const ulong voice, const ulong key, const sample velocity) noexcept override;
+        void stopVoice(const ulong voice) noexcept override;
+        void performVoices(const ulong first, sample* out) noexcept override;
+    public:
+        DspPolySine(sDspChain chain, const ulong nvoices = 16, const sample attack = 10., const sample release = 100.) noexcept;
+        ~DspPolySine();
+        string getName() const noexcept override;
+    };
+}
+
+#endif
+
+
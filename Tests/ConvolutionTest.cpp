@@ -0,0 +1,100 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+#include <chrono>
+#include <thread>
+
+using namespace Kiwi;
+
+// The outputs of the nodes are compared to a convolution computed in double, the
+// error is relative to the sum of the magnitudes of the products.
+static double getError(vector<sample> const& signal, vector<sample> const& input, vector<sample> const& response)
+{
+    double error = signal.size() == input.size() ? 0. : 1.;
+    for(ulong i = 0; i < signal.size() && i < input.size(); i++)
+    {
+        double reference = 0., magnitude = 0.;
+        for(ulong j = 0; j < response.size() && j <= i; j++)
+        {
+            reference += double(response[j]) * double(input[i - j]);
+            magnitude += fabs(double(response[j]) * double(input[i - j]));
+        }
+        error = max(error, fabs(double(signal[i]) - reference) / magnitude);
+    }
+    return error;
+}
+
+// The ticks are paced in real time so the background thread of the convolution
+// has the time to process the tail partitions.
+static double convolve(sDspContext context, shared_ptr<DspTestDeviceManager> device, vector<sample> const& input, vector<sample> const& response, ulong& misses)
+{
+    const ulong vectorsize = device->getVectorSize();
+    sDspChain chain = make_shared<DspChain>(context);
+    context->add(chain);
+    shared_ptr<DspTestSource>   source      = make_shared<DspTestSource>(chain, input);
+    shared_ptr<DspConvolution>  convolution = make_shared<DspConvolution>(chain, response);
+    shared_ptr<DspFir>          fir         = make_shared<DspFir>(chain, response);
+    shared_ptr<DspTestProbe>    probe1      = make_shared<DspTestProbe>(chain, input.size());
+    shared_ptr<DspTestProbe>    probe2      = make_shared<DspTestProbe>(chain, input.size());
+    chain->add(source);
+    chain->add(convolution);
+    chain->add(fir);
+    chain->add(probe1);
+    chain->add(probe2);
+    chain->add(make_shared<DspLink>(chain, source, 0, convolution, 0));
+    chain->add(make_shared<DspLink>(chain, source, 0, fir, 0));
+    chain->add(make_shared<DspLink>(chain, convolution, 0, probe1, 0));
+    chain->add(make_shared<DspLink>(chain, fir, 0, probe2, 0));
+    chain->start();
+    const chrono::microseconds period(vectorsize * 1000000 / device->getSampleRate());
+    for(ulong i = 0; i < input.size() / vectorsize; i++)
+    {
+        const auto deadline = chrono::steady_clock::now() + period;
+        device->process();
+        this_thread::sleep_until(deadline);
+    }
+    chain->stop();
+    context->remove(chain);
+    misses = convolution->getNumberOfMisses();
+    return max(getError(probe1->getSignal(), input, response), getError(probe2->getSignal(), input, response));
+}
+
+int main()
+{
+    const ulong vectorsize = 64;
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    
+    const double epsilon = numeric_limits<sample>::epsilon();
+    const vector<sample> input = getRandomSignal(vectorsize * 64, 1);
+    bool status = true;
+    ulong misses = 0;
+    const double head = convolve(context, device, input, getRandomSignal(300, 2), misses);
+    status &= check(head <= epsilon * 64., "a short response is convolved in the audio thread like the fir");
+    const double tail = convolve(context, device, input, getRandomSignal(3000, 3), misses);
+    status &= check(misses == 0 && tail <= epsilon * 64., "a long response is convolved with the tail partitions like the fir");
+    context->stop();
+    return status ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+
+using namespace Kiwi;
+
+// The impulse is delayed by a reader performed after its writer, then the reader
+// feeds the writer back through a gain so it's performed before the writer. The
+// feedback loop is compiled at once or added while the chain runs.
+static vector<ulong> getImpulses(vector<sample> const& signal)
+{
+    vector<ulong> impulses;
+    for(ulong i = 0; i < signal.size(); i++)
+    {
+        if(fabs(signal[i] - sample(1.)) < sample(1e-6))
+        {
+            impulses.push_back(i);
+        }
+    }
+    return impulses;
+}
+
+static vector<ulong> delay(sDspContext context, shared_ptr<DspTestDeviceManager> device, const bool feedback, const bool compile, const ulong delay, const ulong offset, const ulong size)
+{
+    sDspChain chain = make_shared<DspChain>(context);
+    context->add(chain);
+    vector<sample> impulse(size, 0.);
+    impulse[offset] = 1.;
+    shared_ptr<DspTestSource>   source  = make_shared<DspTestSource>(chain, impulse);
+    shared_ptr<DspPlus<DspVector>> plus = make_shared<DspPlus<DspVector>>(chain);
+    sDspDelayWrite              writer  = make_shared<DspDelayWrite>(chain, 1000);
+    shared_ptr<DspDelayRead>    reader  = make_shared<DspDelayRead>(chain, writer, sample(delay));
+    shared_ptr<DspFir>          gain    = make_shared<DspFir>(chain, vector<sample>{1.});
+    shared_ptr<DspTestProbe>    probe   = make_shared<DspTestProbe>(chain, size);
+    chain->add(source);
+    chain->add(plus);
+    chain->add(writer);
+    chain->add(reader);
+    chain->add(gain);
+    chain->add(probe);
+    chain->add(make_shared<DspLink>(chain, source, 0, plus, 0));
+    chain->add(make_shared<DspLink>(chain, plus, 0, writer, 0));
+    chain->add(make_shared<DspLink>(chain, reader, 0, gain, 0));
+    chain->add(make_shared<DspLink>(chain, reader, 0, probe, 0));
+    sDspLink link = make_shared<DspLink>(chain, gain, 0, plus, 1);
+    if(feedback && !compile)
+    {
+        chain->add(link);
+    }
+    if(compile)
+    {
+        chain->compile().get();
+    }
+    else
+    {
+        chain->start();
+    }
+    const ulong vectorsize = device->getVectorSize();
+    for(ulong i = 0; i < size / vectorsize; i++)
+    {
+        if(feedback && compile && i == 1)
+        {
+            chain->add(link);
+            chain->compile().get();
+        }
+        device->process();
+    }
+    chain->stop();
+    context->remove(chain);
+    return getImpulses(probe->getSignal());
+}
+
+int main()
+{
+    const ulong vectorsize = 64;
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    
+    bool status = true;
+    status &= check(delay(context, device, false, false, 100, 0, 1024) == vector<ulong>{100}, "a reader after its writer delays an impulse");
+    status &= check(delay(context, device, false, false, 10, 0, 1024) == vector<ulong>{10}, "a reader after its writer delays an impulse by less than a vector");
+    status &= check(delay(context, device, true, false, 100, 0, 1024) == vector<ulong>({100, 200, 300, 400, 500, 600, 700, 800, 900, 1000}), "a reader before its writer feeds it back");
+    status &= check(delay(context, device, true, false, 10, 0, 256) == vector<ulong>({64, 128, 192}), "a reader before its writer delays by a vector at least");
+    status &= check(delay(context, device, true, true, 100, 256, 1024) == vector<ulong>({356, 456, 556, 656, 756, 856, 956}), "a reader moved before its writer by a compilation feeds it back");
+    context->stop();
+    return status ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+#include <chrono>
+
+using namespace Kiwi;
+
+// The decay node runs one-pole states that decay from one to the denormal range
+// in a few hundred samples and stay there, like the tail of a filter.
+class DspDecay : public DspNode
+{
+private:
+    static const ulong c_nstates = 8;
+    sample m_states[c_nstates];
+public:
+    DspDecay(sDspChain chain) noexcept : DspNode(chain, 0, 1)
+    {
+        for(ulong i = 0; i < c_nstates; i++)
+        {
+            m_states[i] = 1.;
+        }
+    }
+    
+    string getName() const noexcept override {return "Decay";}
+    void prepare() noexcept override {shouldPerform(true);}
+    void release() noexcept override {}
+    
+    void perform() noexcept override
+    {
+        sample* out1 = getOutputsSamples()[0];
+        for(ulong i = 0; i < getVectorSize(); i++)
+        {
+            sample sum = 0.;
+            for(ulong j = 0; j < c_nstates; j++)
+            {
+                m_states[j] *= sample(0.9);
+                sum += m_states[j];
+            }
+            out1[i] = sum;
+        }
+    }
+};
+
+int main()
+{
+    const ulong vectorsize  = 64;
+    const ulong nnodes      = 16;
+    const ulong nvectors    = 2000;
+    RealTimeChecker::reset();
+    for(int flush = 0; flush < 2; flush++)
+    {
+        shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+        device->setDenormalsFlushing(flush);
+        sDspContext context = make_shared<DspContext>(device);
+        context->start();
+        sDspChain chain = make_shared<DspChain>(context);
+        context->add(chain);
+        for(ulong i = 0; i < nnodes; i++)
+        {
+            chain->add(make_shared<DspDecay>(chain));
+        }
+        chain->start();
+        
+        // The states reach the denormal range before the measure.
+        for(ulong i = 0; i < 20; i++)
+        {
+            device->process();
+        }
+        const auto start = chrono::steady_clock::now();
+        for(ulong i = 0; i < nvectors; i++)
+        {
+            device->process();
+        }
+        const auto end = chrono::steady_clock::now();
+        printf("%lu decay nodes %s flushing: %.2f us per vector of %lu samples\n", nnodes, flush ? "with" : "without", chrono::duration<double, micro>(end - start).count() / double(nvectors), vectorsize);
+        chain->stop();
+        context->stop();
+    }
+    return checkRealTime("the ticks don't allocate, lock or call the system") ? 0 : 1;
+}
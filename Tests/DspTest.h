@@ -0,0 +1,197 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_DSP_TEST__
+#define __DEF_KIWI_DSP_TEST__
+
+#include "../Dsp.h"
+#include <cstdio>
+#include <random>
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      TEST DEVICE                                 //
+    // ================================================================================ //
+    
+    //! The test device manager ticks its contexts without audio driver.
+    /**
+     The test device manager owns the vectors of its inputs and outputs and ticks the contexts each time it processes, so the checks and the benchmarks run the chains offline and as fast as possible.
+     */
+    class DspTestDeviceManager : public DspDeviceManager
+    {
+    private:
+        ulong           m_samplerate;
+        ulong           m_vectorsize;
+        const ulong     m_ninputs;
+        const ulong     m_noutputs;
+        vector<sample>  m_inputs;
+        vector<sample>  m_outputs;
+    public:
+        DspTestDeviceManager(const ulong vectorsize = 64, const ulong ninputs = 2, const ulong noutputs = 2) :
+        m_samplerate(44100),
+        m_vectorsize(vectorsize),
+        m_ninputs(ninputs),
+        m_noutputs(noutputs),
+        m_inputs(ninputs * vectorsize, 0.),
+        m_outputs(noutputs * vectorsize, 0.)
+        {
+            ;
+        }
+        
+        void getAvailableDrivers(vector<string>& drivers) const override {drivers = {"Test"};}
+        string getDriverName() const override {return "Test";}
+        void getAvailableInputDevices(vector<string>& devices) const override {devices = {"Test"};}
+        void getAvailableOutputDevices(vector<string>& devices) const override {devices = {"Test"};}
+        string getInputDeviceName() const override {return "Test";}
+        string getOutputDeviceName() const override {return "Test";}
+        ulong getNumberOfInputs() const override {return m_ninputs;}
+        ulong getNumberOfOutputs() const override {return m_noutputs;}
+        void getAvailableSampleRates(vector<ulong>& samplerates) const override {samplerates = {44100, 48000, 96000};}
+        ulong getVectorSize() const override {return m_vectorsize;}
+        void getAvailableVectorSizes(vector<ulong>& vectorsizes) const override {vectorsizes = {16, 32, 64, 128, 256, 512, 1024};}
+        ulong getSampleRate() const override {return m_samplerate;}
+        void setDriver(string const&) override {}
+        void setInputDevice(string const&) override {}
+        void setOutputDevice(string const&) override {}
+        void setSampleRate(ulong const samplerate) override {m_samplerate = samplerate;}
+        
+        void setVectorSize(ulong const vectorsize) override
+        {
+            m_vectorsize = vectorsize;
+            m_inputs.assign(m_ninputs * vectorsize, 0.);
+            m_outputs.assign(m_noutputs * vectorsize, 0.);
+        }
+        
+        sample const* getInputsSamples(const ulong channel) const noexcept override
+        {
+            return channel < m_ninputs ? m_inputs.data() + channel * m_vectorsize : nullptr;
+        }
+        
+        sample* getOutputsSamples(const ulong channel) const noexcept override
+        {
+            return channel < m_noutputs ? const_cast<sample*>(m_outputs.data()) + channel * m_vectorsize : nullptr;
+        }
+        
+        //! Tick the contexts once.
+        /** The function clears the outputs and ticks the contexts.
+         */
+        void process() noexcept
+        {
+            Signal::vclear(m_noutputs * m_vectorsize, m_outputs.data());
+            tick();
+        }
+    };
+    
+    // ================================================================================ //
+    //                                      TEST NODES                                  //
+    // ================================================================================ //
+    
+    //! The test source node outputs a recorded signal.
+    class DspTestSource : public DspNode
+    {
+    private:
+        const vector<sample> m_signal;
+        ulong                m_position;
+    public:
+        DspTestSource(sDspChain chain, vector<sample> const& signal) noexcept : DspNode(chain, 0, 1), m_signal(signal), m_position(0) {}
+        string getName() const noexcept override {return "TestSource";}
+        void prepare() noexcept override {shouldPerform(true);}
+        void release() noexcept override {}
+        
+        void perform() noexcept override
+        {
+            sample* out1 = getOutputsSamples()[0];
+            for(ulong i = 0; i < getVectorSize(); i++)
+            {
+                out1[i] = m_position < m_signal.size() ? m_signal[m_position++] : 0.;
+            }
+        }
+    };
+    
+    //! The test probe node records its input.
+    class DspTestProbe : public DspNode
+    {
+    private:
+        vector<sample> m_signal;
+    public:
+        DspTestProbe(sDspChain chain, const ulong size = 0) : DspNode(chain, 1, 0) {m_signal.reserve(size);}
+        string getName() const noexcept override {return "TestProbe";}
+        void prepare() noexcept override {shouldPerform(true);}
+        void release() noexcept override {}
+        vector<sample> const& getSignal() const noexcept {return m_signal;}
+        
+        void perform() noexcept override
+        {
+            const sample* in1 = getInputsSamples()[0];
+            m_signal.insert(m_signal.end(), in1, in1 + getVectorSize());
+        }
+    };
+    
+    // ================================================================================ //
+    //                                      TEST                                        //
+    // ================================================================================ //
+    
+    //! Check a condition and print the result.
+    /** The function prints the description of the check and its result.
+     @param status      The result of the check.
+     @param description The description of the check.
+     @return The result of the check.
+     */
+    inline bool check(const bool status, string const& description)
+    {
+        printf("%s %s\n", status ? "passed" : "FAILED", description.c_str());
+        return status;
+    }
+    
+    //! Check that the audio thread respects the real-time constraints.
+    /** The function checks that the real-time checker hasn't recorded any violation since it has been reset. Without __KIWI_DSP_DEBUG__, nothing is recorded and the check passes.
+     @param description The description of the check.
+     @return The result of the check.
+     */
+    inline bool checkRealTime(string const& description)
+    {
+        const ulong violations = RealTimeChecker::getNumberOfViolations(RealTimeChecker::Allocation) + RealTimeChecker::getNumberOfViolations(RealTimeChecker::Lock) + RealTimeChecker::getNumberOfViolations(RealTimeChecker::Syscall);
+        return check(violations == 0, description);
+    }
+    
+    //! Retrieve a random signal.
+    /** The function fills a vector with a white noise between -1 and 1.
+     @param size The number of samples.
+     @param seed The seed of the generator.
+     @return The signal.
+     */
+    inline vector<sample> getRandomSignal(const ulong size, const ulong seed = 1)
+    {
+        mt19937 generator((mt19937::result_type)seed);
+        uniform_real_distribution<double> distribution(-1., 1.);
+        vector<sample> signal(size);
+        for(ulong i = 0; i < size; i++)
+        {
+            signal[i] = sample(distribution(generator));
+        }
+        return signal;
+    }
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+#include <chrono>
+
+using namespace Kiwi;
+
+// The pass node adds one to its input.
+class DspPass : public DspNode
+{
+public:
+    DspPass(sDspChain chain) noexcept : DspNode(chain, 1, 1) {}
+    string getName() const noexcept override {return "Pass";}
+    void prepare() noexcept override {shouldPerform(true);}
+    void release() noexcept override {}
+    
+    void perform() noexcept override
+    {
+        Signal::vcopy(getVectorSize(), getInputsSamples()[0], getOutputsSamples()[0]);
+        Signal::vsadd(getVectorSize(), sample(1.), getOutputsSamples()[0]);
+    }
+};
+
+static double getTime(chrono::steady_clock::time_point const& start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// The chains are made of sequences of ten nodes. The nodes and the links are
+// added, compiled, half of the links and a tenth of the nodes are removed and the
+// chain is compiled again, then one link is added and removed several times.
+int main()
+{
+    const ulong vectorsize  = 64;
+    const ulong ntoggles    = 10;
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    RealTimeChecker::reset();
+    for(ulong size : {25000ul, 50000ul, 100000ul})
+    {
+        sDspChain chain = make_shared<DspChain>(context);
+        context->add(chain);
+        chain->compile().get();
+        vector<sDspNode> nodes;
+        vector<sDspLink> links;
+        
+        auto start = chrono::steady_clock::now();
+        for(ulong i = 0; i < size; i++)
+        {
+            nodes.push_back(make_shared<DspPass>(chain));
+            chain->add(nodes.back());
+        }
+        for(ulong i = 0; i < size; i++)
+        {
+            if(i % 10)
+            {
+                links.push_back(make_shared<DspLink>(chain, nodes[i - 1], 0, nodes[i], 0));
+                chain->add(links.back());
+            }
+        }
+        const double add = getTime(start);
+        
+        start = chrono::steady_clock::now();
+        chain->compile().get();
+        const double compile = getTime(start);
+        
+        start = chrono::steady_clock::now();
+        for(ulong i = 0; i < size / 2; i++)
+        {
+            chain->remove(links[i]);
+        }
+        for(ulong i = 0; i < size / 10; i++)
+        {
+            chain->remove(nodes[i * 10]);
+        }
+        const double remove = getTime(start);
+        
+        start = chrono::steady_clock::now();
+        chain->compile().get();
+        const double recompile = getTime(start);
+        
+        sDspLink link = make_shared<DspLink>(chain, nodes[size / 2 + 1], 0, nodes[size - 1], 0);
+        start = chrono::steady_clock::now();
+        for(ulong i = 0; i < ntoggles; i++)
+        {
+            if(i % 2)
+            {
+                chain->remove(link);
+            }
+            else
+            {
+                chain->add(link);
+            }
+            chain->compile().get();
+        }
+        const double toggle = getTime(start) / double(ntoggles);
+        
+        start = chrono::steady_clock::now();
+        device->process();
+        const double tick = getTime(start);
+        
+        printf("%6lu nodes: add %7.1f ms, compile %7.1f ms, remove %7.1f ms, recompile %7.1f ms, relink %7.1f ms, tick %.2f ms\n", size, add, compile, remove, recompile, toggle, tick);
+        chain->stop();
+        context->remove(chain);
+    }
+    context->stop();
+    return checkRealTime("the ticks don't allocate, lock or call the system") ? 0 : 1;
+}
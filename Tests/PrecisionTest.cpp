@@ -0,0 +1,183 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+
+using namespace Kiwi;
+
+// The nodes in double precision and in single precision are linked in all the
+// combinations and their outputs are compared to a filter computed in double.
+static vector<double> filter(vector<sample> const& coefficients, vector<double> const& input, const bool magnitude = false)
+{
+    vector<double> output(input.size(), 0.);
+    for(ulong i = 0; i < input.size(); i++)
+    {
+        for(ulong j = 0; j < coefficients.size() && j <= i; j++)
+        {
+            const double product = double(coefficients[j]) * input[i - j];
+            output[i] += magnitude ? fabs(product) : product;
+        }
+    }
+    return output;
+}
+
+// The error is relative to a magnitude, the rounding errors of a dot product are
+// bounded by its size times the sum of the magnitudes of its products.
+static double getError(vector<sample> const& signal, vector<double> const& reference, vector<double> const& magnitude)
+{
+    double error = signal.size() == reference.size() ? 0. : 1.;
+    for(ulong i = 0; i < signal.size() && i < reference.size(); i++)
+    {
+        if(magnitude[i] > 0.)
+        {
+            error = max(error, fabs(double(signal[i]) - reference[i]) / magnitude[i]);
+        }
+    }
+    return error;
+}
+
+static vector<double> absolute(vector<double> const& signal)
+{
+    vector<double> magnitude(signal.size());
+    for(ulong i = 0; i < signal.size(); i++)
+    {
+        magnitude[i] = fabs(signal[i]);
+    }
+    return magnitude;
+}
+
+static vector<double> round(vector<double> const& signal)
+{
+    vector<double> rounded(signal.size());
+    for(ulong i = 0; i < signal.size(); i++)
+    {
+        rounded[i] = double(sample(signal[i]));
+    }
+    return rounded;
+}
+
+// A double node linked to a new node is allocated again, the single nodes that
+// already read it must still receive its converted output.
+static bool relink(sDspContext context, shared_ptr<DspTestDeviceManager> device)
+{
+    const ulong vectorsize = device->getVectorSize();
+    sDspChain chain = make_shared<DspChain>(context);
+    context->add(chain);
+    shared_ptr<DspTestSource> source    = make_shared<DspTestSource>(chain, vector<sample>(vectorsize * 2, 1.));
+    shared_ptr<DspFir>        gain      = make_shared<DspFir>(chain, vector<sample>{0.5}, 1, true);
+    shared_ptr<DspTestProbe>  probe1    = make_shared<DspTestProbe>(chain, vectorsize * 2);
+    shared_ptr<DspTestProbe>  probe2    = make_shared<DspTestProbe>(chain, vectorsize * 2);
+    chain->add(source);
+    chain->add(gain);
+    chain->add(probe1);
+    chain->add(probe2);
+    chain->add(make_shared<DspLink>(chain, source, 0, gain, 0));
+    chain->add(make_shared<DspLink>(chain, gain, 0, probe1, 0));
+    chain->start();
+    device->process();
+    chain->add(make_shared<DspLink>(chain, gain, 0, probe2, 0));
+    chain->compile().get();
+    device->process();
+    chain->stop();
+    context->remove(chain);
+    
+    vector<sample> const& signal1 = probe1->getSignal();
+    vector<sample> const& signal2 = probe2->getSignal();
+    return signal1.size() == vectorsize * 2 && signal2.size() == vectorsize * 2 && signal1.back() == sample(0.5) && signal2.back() == sample(0.5);
+}
+
+int main()
+{
+    const ulong vectorsize  = 64;
+    const ulong nvectors    = 64;
+    const ulong size        = vectorsize * nvectors;
+    const vector<sample> input   = getRandomSignal(size, 1);
+    const vector<sample> kernel1 = getRandomSignal(256, 2);
+    const vector<sample> kernel2 = getRandomSignal(256, 3);
+    
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    sDspChain chain = make_shared<DspChain>(context);
+    context->add(chain);
+    
+    // source -> double -> single -> probe
+    //                  -> double -> probe
+    //                  -> probe
+    shared_ptr<DspTestSource> source    = make_shared<DspTestSource>(chain, input);
+    shared_ptr<DspFir>        fir1      = make_shared<DspFir>(chain, kernel1, 1, true);
+    shared_ptr<DspFir>        single    = make_shared<DspFir>(chain, kernel2, 1, false);
+    shared_ptr<DspFir>        dual      = make_shared<DspFir>(chain, kernel2, 1, true);
+    shared_ptr<DspTestProbe>  probe1    = make_shared<DspTestProbe>(chain, size);
+    shared_ptr<DspTestProbe>  probe2    = make_shared<DspTestProbe>(chain, size);
+    shared_ptr<DspTestProbe>  probe3    = make_shared<DspTestProbe>(chain, size);
+    chain->add(source);
+    chain->add(fir1);
+    chain->add(single);
+    chain->add(dual);
+    chain->add(probe1);
+    chain->add(probe2);
+    chain->add(probe3);
+    chain->add(make_shared<DspLink>(chain, source, 0, fir1, 0));
+    chain->add(make_shared<DspLink>(chain, fir1, 0, single, 0));
+    chain->add(make_shared<DspLink>(chain, fir1, 0, dual, 0));
+    chain->add(make_shared<DspLink>(chain, fir1, 0, probe1, 0));
+    chain->add(make_shared<DspLink>(chain, single, 0, probe2, 0));
+    chain->add(make_shared<DspLink>(chain, dual, 0, probe3, 0));
+    try
+    {
+        chain->start();
+    }
+    catch(DspError& e)
+    {
+        printf("FAILED %s\n", e.what());
+        return 1;
+    }
+    for(ulong i = 0; i < nvectors; i++)
+    {
+        device->process();
+    }
+    
+    // The single precision node receives the rounded output of the double node, the
+    // double node receives it without rounding.
+    const vector<double> signal     = vector<double>(input.begin(), input.end());
+    const vector<double> output1    = filter(kernel1, signal);
+    const vector<double> output2    = filter(kernel2, round(output1));
+    const vector<double> output3    = filter(kernel2, output1);
+    const vector<double> magnitude  = filter(kernel2, round(output1), true);
+    const double epsilon  = numeric_limits<sample>::epsilon();
+    const double rounding = numeric_limits<float>::epsilon();
+    
+    // The outputs of the double nodes are only rounded once, the single node rounds
+    // its products and its sums.
+    bool status = true;
+    status &= check(fir1->isDoublePrecision() && dual->isDoublePrecision(), "the double nodes use the double precision");
+    status &= check(getError(probe1->getSignal(), output1, absolute(output1)) <= rounding, "a double output is converted to a single input");
+    status &= check(getError(probe2->getSignal(), output2, magnitude) <= epsilon * double(kernel2.size()), "a double output is converted to a single node");
+    status &= check(getError(probe3->getSignal(), output3, absolute(output3)) <= rounding, "a double output is linked to a double node without rounding");
+    chain->stop();
+    context->remove(chain);
+    status &= check(relink(context, device), "a double output linked again is still converted to its single inputs");
+    context->stop();
+    return status ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+
+using namespace Kiwi;
+
+// The allocating node is the control of the check, it allocates in the audio thread.
+class DspAllocating : public DspNode
+{
+private:
+    vector<sample> m_buffer;
+public:
+    DspAllocating(sDspChain chain) noexcept : DspNode(chain, 1, 0) {}
+    string getName() const noexcept override {return "Allocating";}
+    void prepare() noexcept override {shouldPerform(true);}
+    void release() noexcept override {}
+    
+    void perform() noexcept override
+    {
+        m_buffer.assign(getInputsSamples()[0], getInputsSamples()[0] + getVectorSize());
+        m_buffer.shrink_to_fit();
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+    }
+};
+
+static ulong getNumberOfViolations()
+{
+    return RealTimeChecker::getNumberOfViolations(RealTimeChecker::Allocation) + RealTimeChecker::getNumberOfViolations(RealTimeChecker::Lock) + RealTimeChecker::getNumberOfViolations(RealTimeChecker::Syscall);
+}
+
+// The modules are performed while their parameters, their coefficients, their
+// responses and their notes change, then the violations of the audio thread are
+// counted. The check is only meaningful with __KIWI_DSP_DEBUG__.
+int main()
+{
+#ifndef __KIWI_DSP_DEBUG__
+    printf("skipped the real-time checker needs __KIWI_DSP_DEBUG__\n");
+    return 0;
+#else
+    const ulong vectorsize  = 64;
+    const ulong nvectors    = 512;
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    sDspChain chain = make_shared<DspChain>(context);
+    context->add(chain);
+    
+    shared_ptr<DspAdc>              adc     = make_shared<DspAdc>(chain, vector<ulong>{1});
+    shared_ptr<DspFir>              fir     = make_shared<DspFir>(chain, getRandomSignal(64, 1));
+    shared_ptr<DspPlus<DspScalar>>  plus    = make_shared<DspPlus<DspScalar>>(chain, 0.5);
+    shared_ptr<DspConvolution>      conv    = make_shared<DspConvolution>(chain, getRandomSignal(8192, 2));
+    shared_ptr<DspDelayWrite>       writer  = make_shared<DspDelayWrite>(chain, 4096);
+    shared_ptr<DspDelayRead>        reader  = make_shared<DspDelayRead>(chain, writer, 100.);
+    shared_ptr<DspPolySine>         poly    = make_shared<DspPolySine>(chain);
+    shared_ptr<DspNoise>            noise   = make_shared<DspNoise>(chain);
+    shared_ptr<DspSig>              sig     = make_shared<DspSig>(chain, 1.);
+    shared_ptr<DspPlus<DspVector>>  mix     = make_shared<DspPlus<DspVector>>(chain);
+    shared_ptr<DspRms>              rms     = make_shared<DspRms>(chain);
+    shared_ptr<DspPeak>             peak    = make_shared<DspPeak>(chain);
+    shared_ptr<DspDac>              dac     = make_shared<DspDac>(chain, vector<ulong>{1, 2});
+    const vector<sDspNode> nodes = {adc, fir, plus, conv, writer, reader, poly, noise, sig, mix, rms, peak, dac};
+    for(ulong i = 0; i < nodes.size(); i++)
+    {
+        chain->add(nodes[i]);
+    }
+    chain->add(make_shared<DspLink>(chain, adc, 0, fir, 0));
+    chain->add(make_shared<DspLink>(chain, fir, 0, plus, 0));
+    chain->add(make_shared<DspLink>(chain, plus, 0, conv, 0));
+    chain->add(make_shared<DspLink>(chain, conv, 0, writer, 0));
+    chain->add(make_shared<DspLink>(chain, reader, 0, mix, 0));
+    chain->add(make_shared<DspLink>(chain, poly, 0, mix, 1));
+    chain->add(make_shared<DspLink>(chain, noise, 0, peak, 0));
+    chain->add(make_shared<DspLink>(chain, sig, 0, rms, 0));
+    chain->add(make_shared<DspLink>(chain, mix, 0, dac, 0));
+    chain->add(make_shared<DspLink>(chain, poly, 0, dac, 1));
+    try
+    {
+        chain->start();
+    }
+    catch(DspError& e)
+    {
+        printf("FAILED %s\n", e.what());
+        return 1;
+    }
+    
+    RealTimeChecker::reset();
+    for(ulong i = 0; i < nvectors; i++)
+    {
+        switch(i % 64)
+        {
+            case 0:
+                poly->noteOn(60 + (i / 64) % 12, 1.);
+                break;
+            case 8:
+                plus->setValue(sample(i % 3), vectorsize / 2);
+                break;
+            case 16:
+                sig->setValue(sample(i % 5));
+                break;
+            case 24:
+                fir->setCoefficients(getRandomSignal(64, i));
+                break;
+            case 32:
+                conv->setResponse(getRandomSignal(8192, i));
+                break;
+            case 40:
+                reader->setDelay(sample(i % 1000));
+                break;
+            case 48:
+                poly->noteOff(60 + (i / 64) % 12);
+                break;
+            default:
+                break;
+        }
+        device->process();
+        rms->getValue();
+        peak->getValue();
+    }
+    const ulong violations = getNumberOfViolations();
+    
+    // The control node must be detected.
+    shared_ptr<DspAllocating> allocating = make_shared<DspAllocating>(chain);
+    chain->add(allocating);
+    chain->add(make_shared<DspLink>(chain, noise, 0, allocating, 0));
+    chain->compile().get();
+    RealTimeChecker::reset();
+    device->process();
+    const ulong controls = getNumberOfViolations();
+    
+    bool status = true;
+    status &= check(violations == 0, "the modules don't allocate, lock or call the system in the audio thread");
+    status &= check(controls > 0, "an allocation in the audio thread is detected");
+    chain->stop();
+    context->stop();
+    return status ? 0 : 1;
+#endif
+}
@@ -0,0 +1,125 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+#include <chrono>
+
+using namespace Kiwi;
+
+// The pass node adds one to its input.
+class DspPass : public DspNode
+{
+public:
+    DspPass(sDspChain chain) noexcept : DspNode(chain, 1, 1) {}
+    string getName() const noexcept override {return "Pass";}
+    void prepare() noexcept override {shouldPerform(true);}
+    void release() noexcept override {}
+    
+    void perform() noexcept override
+    {
+        Signal::vcopy(getVectorSize(), getInputsSamples()[0], getOutputsSamples()[0]);
+        Signal::vsadd(getVectorSize(), sample(1.), getOutputsSamples()[0]);
+    }
+};
+
+static double getTime(chrono::steady_clock::time_point const& start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// The deep chain is one sequence of a million nodes, the wide chain is made of
+// sequences of sixteen nodes. The nodes are added in the reverse order so the
+// sort must move all of them. The probe receives the number of nodes of the last
+// sequence after one tick if they are sorted. Then the last node is linked back
+// to the middle of the deep chain or to the start of the last sequence of the
+// wide chain, and the loop must be found.
+int main()
+{
+    const ulong vectorsize  = 64;
+    const ulong size        = 1000000;
+    const ulong sequence    = 16;
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    bool status = true;
+    RealTimeChecker::reset();
+    for(bool deep : {true, false})
+    {
+        sDspChain chain = make_shared<DspChain>(context);
+        context->add(chain);
+        chain->compile().get();
+        vector<sDspNode> nodes;
+        for(ulong i = 0; i < size; i++)
+        {
+            nodes.push_back(make_shared<DspPass>(chain));
+        }
+        for(ulong i = size; i--;)
+        {
+            chain->add(nodes[i]);
+        }
+        for(ulong i = 1; i < size; i++)
+        {
+            if(deep || i % sequence)
+            {
+                chain->add(make_shared<DspLink>(chain, nodes[i - 1], 0, nodes[i], 0));
+            }
+        }
+        shared_ptr<DspTestProbe> probe = make_shared<DspTestProbe>(chain, vectorsize);
+        chain->add(probe);
+        chain->add(make_shared<DspLink>(chain, nodes[size - 1], 0, probe, 0));
+        
+        auto start = chrono::steady_clock::now();
+        chain->compile().get();
+        const double compile = getTime(start);
+        
+        start = chrono::steady_clock::now();
+        device->process();
+        const double tick = getTime(start);
+        
+        const ulong last = deep ? size : (size - 1) % sequence + 1;
+        const string name = deep ? "deep" : "wide";
+        status &= check(probe->getSignal().size() == vectorsize && probe->getSignal().back() == sample(last), "the nodes of the " + name + " chain are sorted");
+        
+        const ulong back = deep ? size / 2 : size - last;
+        chain->add(make_shared<DspLink>(chain, nodes[size - 1], 0, nodes[back], 0));
+        ulong loop = 0;
+        start = chrono::steady_clock::now();
+        try
+        {
+            chain->compile().get();
+        }
+        catch(DspError& e)
+        {
+            loop = e.getLoops().empty() ? 0 : (ulong)e.getLoops()[0].size();
+        }
+        const double detect = getTime(start);
+        status &= check(loop == size - back, "the loop of the " + name + " chain is found");
+        
+        printf("%s %lu nodes: compile %7.1f ms, tick %6.2f ms, loop of %lu nodes found in %7.1f ms\n", name.c_str(), size, compile, tick, loop, detect);
+        chain->stop();
+        context->remove(chain);
+    }
+    context->stop();
+    status &= checkRealTime("the ticks don't allocate, lock or call the system");
+    return status ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+
+using namespace Kiwi;
+
+// The spectra of the fft are compared to a discrete fourier transform computed in
+// double, for the sizes of the different radices.
+static double getFftError(const ulong size)
+{
+    const vector<sample> signal = getRandomSignal(size, size);
+    const ulong nbins = size / 2 + 1;
+    vector<sample> real(nbins), imag(nbins), output(size);
+    sFftSetup setup = Fft::create(size);
+    Fft::forward(*setup, signal.data(), real.data(), imag.data());
+    Fft::inverse(*setup, real.data(), imag.data(), output.data());
+    
+    double error = 0., magnitude = 0.;
+    for(ulong i = 0; i < nbins; i++)
+    {
+        double re = 0., im = 0.;
+        for(ulong j = 0; j < size; j++)
+        {
+            const double phase = -2. * M_PI * double((i * j) % size) / double(size);
+            re += double(signal[j]) * cos(phase);
+            im += double(signal[j]) * sin(phase);
+        }
+        error = max(error, max(fabs(re - double(real[i])), fabs(im - double(imag[i]))));
+        magnitude = max(magnitude, max(fabs(re), fabs(im)));
+    }
+    error /= magnitude;
+    for(ulong i = 0; i < size; i++)
+    {
+        error = max(error, fabs(double(output[i]) - double(signal[i])));
+    }
+    return error;
+}
+
+// The processor leaves the spectra unchanged.
+class Identity : public Stft::Processor
+{
+public:
+    void process(sample*, sample*) noexcept override {}
+};
+
+// Without processing, the stft returns the signal delayed by its latency once the
+// frames fully overlap.
+static double getStftError(const ulong size, const ulong hop, const Stft::Window window, const ulong vectorsize)
+{
+    const ulong length = size * 8;
+    const vector<sample> signal = getRandomSignal(length, size + hop);
+    vector<sample> output(length);
+    Identity identity;
+    Stft stft(size, hop, window);
+    stft.prepare(vectorsize);
+    for(ulong i = 0; i < length; i += vectorsize)
+    {
+        stft.perform(identity, signal.data() + i, output.data() + i, vectorsize);
+    }
+    
+    double error = 0.;
+    for(ulong i = size; i + stft.getLatency() < length; i++)
+    {
+        error = max(error, fabs(double(output[i + stft.getLatency()]) - double(signal[i])));
+    }
+    return error;
+}
+
+int main()
+{
+    const double epsilon = numeric_limits<sample>::epsilon();
+    bool status = true;
+    for(ulong size : {16ul, 64ul, 1024ul, 60ul, 96ul, 126ul, 14ul, 22ul})
+    {
+        status &= check(getFftError(size) <= epsilon * 64., "the fft of " + to_string(size) + " samples matches the discrete fourier transform");
+    }
+    status &= check(getStftError(512, 128, Stft::Hann, 64) <= epsilon * 64., "the stft with a Hann window and a hop of a quarter returns the signal");
+    status &= check(getStftError(512, 256, Stft::Hamming, 64) <= epsilon * 64., "the stft with a Hamming window and a hop of a half returns the signal");
+    status &= check(getStftError(480, 160, Stft::Blackman, 32) <= epsilon * 64., "the stft with a Blackman window and a hop of a third returns the signal");
+    status &= check(getStftError(256, 256, Stft::Rectangular, 64) <= epsilon * 64., "the stft with a rectangular window without overlap returns the signal");
+    return status ? 0 : 1;
+}
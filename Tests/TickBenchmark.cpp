@@ -0,0 +1,115 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "DspTest.h"
+#include <chrono>
+
+using namespace Kiwi;
+
+// The mix node sums its two inputs with two gains, it isn't inplace so its
+// output keeps its own vector.
+class DspMix : public DspNode
+{
+public:
+    DspMix(sDspChain chain) noexcept : DspNode(chain, 2, 1) {}
+    string getName() const noexcept override {return "Mix";}
+    void prepare() noexcept override {shouldPerform(true); setInplace(false);}
+    void release() noexcept override {}
+    
+    void perform() noexcept override
+    {
+        const sample* in1 = getInputsSamples()[0];
+        const sample* in2 = getInputsSamples()[1];
+        sample* out1 = getOutputsSamples()[0];
+        for(ulong i = 0; i < getVectorSize(); i++)
+        {
+            out1[i] = in1[i] * sample(0.5) + in2[i] * sample(0.25);
+        }
+    }
+};
+
+static double getTime(chrono::steady_clock::time_point const& start)
+{
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+
+// The graph is random, each node receives one link on its first input and two
+// links on its second input from the nodes created before it. The construction
+// of the nodes is timed apart from the chain, the ticks are timed after a few
+// ones that warm the caches.
+int main()
+{
+    const ulong vectorsize  = 64;
+    const ulong size        = 20000;
+    const ulong nwarmups    = 50;
+    const ulong nticks      = 400;
+    shared_ptr<DspTestDeviceManager> device = make_shared<DspTestDeviceManager>(vectorsize);
+    sDspContext context = make_shared<DspContext>(device);
+    context->start();
+    sDspChain chain = make_shared<DspChain>(context);
+    context->add(chain);
+    
+    vector<sDspNode> nodes;
+    nodes.reserve(size);
+    auto start = chrono::steady_clock::now();
+    for(ulong i = 0; i < size; i++)
+    {
+        nodes.push_back(make_shared<DspMix>(chain));
+    }
+    const double construct = getTime(start) / 1000.;
+    
+    mt19937 generator(1);
+    for(ulong i = 0; i < size; i++)
+    {
+        chain->add(nodes[i]);
+    }
+    for(ulong i = 1; i < size; i++)
+    {
+        chain->add(make_shared<DspLink>(chain, nodes[generator() % i], 0, nodes[i], 0));
+        chain->add(make_shared<DspLink>(chain, nodes[generator() % i], 0, nodes[i], 1));
+        chain->add(make_shared<DspLink>(chain, nodes[generator() % i], 0, nodes[i], 1));
+    }
+    chain->start();
+    RealTimeChecker::reset();
+    for(ulong i = 0; i < nwarmups; i++)
+    {
+        device->process();
+    }
+    
+    double best = numeric_limits<double>::max();
+    double total = 0.;
+    for(ulong i = 0; i < nticks; i++)
+    {
+        start = chrono::steady_clock::now();
+        device->process();
+        const double tick = getTime(start);
+        best = min(best, tick);
+        total += tick;
+    }
+    
+    printf("%lu nodes: construct %.2f ms, tick of %lu samples best %.1f us, average %.1f us\n", size, construct, vectorsize, best, total / double(nticks));
+    chain->stop();
+    context->remove(chain);
+    context->stop();
+    return checkRealTime("the ticks don't allocate, lock or call the system") ? 0 : 1;
+}